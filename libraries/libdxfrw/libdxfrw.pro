@@ -36,6 +36,7 @@ SOURCES += \
     src/drw_objects.cpp \
     src/intern/drw_textcodec.cpp \
     src/intern/dxfreader.cpp \
+    src/intern/dxfreaderparallel.cpp \
     src/intern/dxfwriter.cpp \
     src/intern/dwgreader.cpp \
     src/intern/dwgbuffer.cpp \
@@ -59,6 +60,7 @@ HEADERS += \
     src/drw_objects.h \
     src/intern/drw_textcodec.h \
     src/intern/dxfreader.h \
+    src/intern/dxfreaderparallel.h \
     src/intern/dxfwriter.h \
     src/intern/dwgreader.h \
     src/intern/dwgbuffer.h \
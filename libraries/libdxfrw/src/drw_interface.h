@@ -185,6 +185,17 @@ public:
      */
     virtual void addComment(const char* comment) = 0;
 
+    /**
+     * Called every few thousand records while a DXF file is read.
+     * @param done bytes of the file read so far
+     * @param total size of the file in bytes
+     * @return false to cancel reading, dxfRW::read() fails then
+     */
+    virtual bool readProgress(unsigned long long done, unsigned long long total) {
+        (void)done; (void)total;
+        return true;
+    }
+
     virtual void writeHeader(DRW_Header& data) = 0;
     virtual void writeBlocks() = 0;
     virtual void writeBlockRecords() = 0;
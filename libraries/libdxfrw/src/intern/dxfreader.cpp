@@ -11,17 +11,145 @@
 ******************************************************************************/
 
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <locale>
 #include <string>
 #include <sstream>
 #include "dxfreader.h"
 #include "drw_textcodec.h"
 #include "drw_dbg.h"
+#include "../drw_interface.h"
+
+namespace {
+//size of the blocks read by dxfReaderAscii
+const size_t blockSize = 1 << 20;
+
+//records read between two progress reports
+const unsigned int progressInterval = 4096;
+
+//powers of ten exactly representable as double
+const double exactPowers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/**
+ * Parses an integer like atoi(), without a terminating null.
+ */
+int toInt(const char *p, const char *end) {
+    while (p < end && isSpace(*p))
+        ++p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    long long value = 0;
+    for (; p < end && isDigit(*p) && value < 0x100000000LL; ++p)
+        value = value*10 + (*p - '0');
+    return static_cast<int>(negative ? -value : value);
+}
+
+/**
+ * Parses a decimal number exactly if its significand fits in a double
+ * and the power of ten is exactly representable too, i.e. the result
+ * of one correctly rounded multiplication or division.
+ * @return false if the number has to be parsed by the standard library
+ */
+bool toDoubleFast(const char *p, const char *end, double *value) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    unsigned long long significand = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p) {
+        any = true;
+        if (digits >= 19)
+            return false;
+        significand = significand*10 + (*p - '0');
+        if (significand > 0)
+            ++digits;
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && isDigit(*p); ++p) {
+            any = true;
+            if (digits >= 19) {
+                if (*p != '0')
+                    return false;
+                continue;
+            }
+            significand = significand*10 + (*p - '0');
+            if (significand > 0)
+                ++digits;
+            --exponent;
+        }
+    }
+    if (!any)
+        return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExp = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExp = *p == '-';
+            ++p;
+        }
+        if (p == end || !isDigit(*p))
+            return false;
+        int e = 0;
+        for (; p < end && isDigit(*p); ++p) {
+            if (e > 1000)
+                return false;
+            e = e*10 + (*p - '0');
+        }
+        exponent += negativeExp ? -e : e;
+    }
+    while (p < end && isSpace(*p))
+        ++p;
+    if (p != end || significand > (1ULL << 53) || exponent < -22 || exponent > 22)
+        return false;
+
+    double result = static_cast<double>(significand);
+    if (exponent < 0)
+        result /= exactPowers[-exponent];
+    else
+        result *= exactPowers[exponent];
+    *value = negative ? -result : result;
+    return true;
+}
+}
+
+bool dxfReader::reportProgress() {
+    records = 0;
+    if (!progress->readProgress(getPos(), fileSize)) {
+        DRW_DBG("dxfReader::readRec reading cancelled\n");
+        cancelled = true;
+    }
+    return !cancelled;
+}
 
 bool dxfReader::readRec(int *codeData) {
 //    std::string text;
     int code;
 
+    if (cancelled)
+        return false;
+    if (progress != NULL && ++records == progressInterval && !reportProgress())
+        return false;
     if (!readCode(&code))
         return false;
     *codeData = code;
@@ -85,8 +213,25 @@ bool dxfReader::readRec(int *codeData) {
         //break in binary files because the conduct is unpredictable
         return false;
 
-    return (filestr->good());
+    return isGood();
+}
+
+void dxfReader::shareSettings(dxfReader *reader) {
+    decoder.setVersion(reader->decoder.getVersion(), true);
+    std::string cp = reader->decoder.getCodePage();
+    decoder.setCodePage(&cp, true);
+    progress = reader->progress;
+    fileSize = reader->fileSize;
+}
+
+bool dxfReader::isGood() {
+    return filestr->good();
+}
+
+unsigned long long dxfReader::getPos() {
+    return static_cast<unsigned long long>(filestr->tellg());
 }
+
 int dxfReader::getHandleString(){
     int res;
 #if defined(__APPLE__)
@@ -184,81 +329,154 @@ bool dxfReaderBinary::readBool() {
     return (filestr->good());
 }
 
+dxfReaderAscii::dxfReaderAscii(std::ifstream *stream):dxfReader(stream),
+    buffer(blockSize), begin(0), end(0), offset(0), good(true) {
+    skip = true;
+}
+
+dxfReaderAscii::dxfReaderAscii(std::vector<char> *data):dxfReader(NULL),
+    begin(0), end(data->size()), offset(0), good(true) {
+    skip = true;
+    buffer.swap(*data);
+    if (buffer.empty())
+        buffer.resize(1);
+}
+
+/**
+ * Copies whole records to chunk, every line ending in '\n', until it
+ * holds size bytes and the next record starts an entity (group code 0).
+ * That record is left unread. A record cut by the end of the file is
+ * dropped, like readRec() fails on it.
+ * @return false once the section or the file ended
+ */
+bool dxfReaderAscii::readSection(std::vector<char> *chunk, size_t size) {
+    const char *line;
+    size_t len;
+    for (;;) {
+        if (!readLine(&line, &len))
+            return false;
+        int code = toInt(line, line + len);
+        if (code == 0 && chunk->size() >= size) {
+            begin = line - &buffer[0];
+            return true;
+        }
+        size_t recordStart = chunk->size();
+        chunk->insert(chunk->end(), line, line + len);
+        chunk->push_back('\n');
+        //line is invalid from here, the buffer may move
+        if (!readLine(&line, &len)) {
+            chunk->resize(recordStart);
+            return false;
+        }
+        chunk->insert(chunk->end(), line, line + len);
+        chunk->push_back('\n');
+        if (code == 0 && ((len == 6 && memcmp(line, "ENDSEC", 6) == 0)
+                          || (len == 3 && memcmp(line, "EOF", 3) == 0)))
+            return false;
+    }
+}
+
+bool dxfReaderAscii::readLine(const char **line, size_t *len) {
+    for (;;) {
+        char *data = &buffer[0];
+        const char *lineEnd = static_cast<const char *>(memchr(data + begin, '\n', end - begin));
+        if (lineEnd != NULL) {
+            *line = data + begin;
+            *len = lineEnd - *line;
+            begin += *len + 1;
+            break;
+        }
+        if (filestr == NULL || !filestr->good()) {
+            //the rest of the file is the last line, like std::getline
+            *line = data + begin;
+            *len = end - begin;
+            begin = end;
+            good = false;
+            break;
+        }
+        //keep the incomplete line and read the next block after it
+        if (begin > 0) {
+            memmove(data, data + begin, end - begin);
+            end -= begin;
+            offset += begin;
+            begin = 0;
+        }
+        if (end == buffer.size())
+            buffer.resize(2 * buffer.size());
+        filestr->read(&buffer[end], buffer.size() - end);
+        end += filestr->gcount();
+    }
+    if (*len > 0 && (*line)[*len - 1] == '\r')
+        --*len;
+    return good;
+}
+
 bool dxfReaderAscii::readCode(int *code) {
-    std::string text;
-    std::getline(*filestr, text);
-    *code = atoi(text.c_str());
+    const char *line;
+    size_t len;
+    readLine(&line, &len);
+    *code = toInt(line, line + len);
     DRW_DBG(*code); DRW_DBG("\n");
-    return (filestr->good());
+    return good;
 }
+
 bool dxfReaderAscii::readString(std::string *text) {
     type = STRING;
-    std::getline(*filestr, *text);
-    if (!text->empty() && text->at(text->size()-1) == '\r')
-        text->erase(text->size()-1);
-    return (filestr->good());
+    const char *line;
+    size_t len;
+    readLine(&line, &len);
+    text->assign(line, len);
+    return good;
 }
 
 bool dxfReaderAscii::readString() {
-    type = STRING;
-    std::getline(*filestr, strData);
-    if (!strData.empty() && strData.at(strData.size()-1) == '\r')
-        strData.erase(strData.size()-1);
+    readString(&strData);
     DRW_DBG(strData); DRW_DBG("\n");
-    return (filestr->good());
+    return good;
+}
+
+bool dxfReaderAscii::parseInt(int *value) {
+    const char *line;
+    size_t len;
+    if (!readLine(&line, &len))
+        return false;
+    *value = toInt(line, line + len);
+    DRW_DBG(*value); DRW_DBG("\n");
+    return true;
 }
 
 bool dxfReaderAscii::readInt16() {
     type = INT32;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
-        DRW_DBG(intData); DRW_DBG("\n");
-        return true;
-    } else
-        return false;
+    return parseInt(&intData);
 }
 
 bool dxfReaderAscii::readInt32() {
     type = INT32;
-    return readInt16();
+    return parseInt(&intData);
 }
 
 bool dxfReaderAscii::readInt64() {
     type = INT64;
-    return readInt16();
+    return parseInt(&intData);
 }
 
 bool dxfReaderAscii::readDouble() {
     type = DOUBLE;
-    std::string text;
-    if (readString(&text)){
-#if defined(__APPLE__)
-        int succeeded=sscanf( & (text[0]), "%lg", &doubleData);
-        if(succeeded != 1) {
-            DRW_DBG("dxfReaderAscii::readDouble(): reading double error: ");
-            DRW_DBG(text);
-            DRW_DBG('\n');
-        }
-#else
-        std::istringstream sd(text);
-        sd >> doubleData;
-        DRW_DBG(doubleData); DRW_DBG('\n');
-#endif
-        return true;
-    } else
+    const char *line;
+    size_t len;
+    if (!readLine(&line, &len))
         return false;
+    if (!toDoubleFast(line, line + len, &doubleData)) {
+        std::istringstream sd(std::string(line, len));
+        sd.imbue(std::locale::classic());
+        sd >> doubleData;
+    }
+    DRW_DBG(doubleData); DRW_DBG('\n');
+    return true;
 }
 
 //saved as int or add a bool member??
 bool dxfReaderAscii::readBool() {
     type = BOOL;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
-        DRW_DBG(intData); DRW_DBG("\n");
-        return true;
-    } else
-        return false;
+    return parseInt(&intData);
 }
-
@@ -13,8 +13,11 @@
 #ifndef DXFREADER_H
 #define DXFREADER_H
 
+#include <vector>
 #include "drw_textcodec.h"
 
+class DRW_Interface;
+
 class dxfReader {
 public:
     enum TYPE {
@@ -30,9 +33,24 @@ public:
     dxfReader(std::ifstream *stream){
         filestr = stream;
         type = INVALID;
+        progress = NULL;
+        fileSize = 0;
+        records = 0;
+        cancelled = false;
     }
     virtual ~dxfReader(){}
     bool readRec(int *code);
+    //report the progress to iface, readRec fails once it cancels reading
+    void setProgress(DRW_Interface *iface, unsigned long long size) {
+        progress = iface;
+        fileSize = size;
+    }
+    bool isCancelled() {return cancelled;}
+    void cancel() {cancelled = true;}
+    //return false after the end of the file or a read error
+    virtual bool isGood();
+    //decode strings and report the progress like reader
+    void shareSettings(dxfReader *reader);
 
     std::string getString() {return strData;}
     int getHandleString();//Convert hex string to int
@@ -56,6 +74,8 @@ protected:
     virtual bool readInt64() = 0;
     virtual bool readDouble() = 0;
     virtual bool readBool() = 0;
+    //offset in the file of the next record
+    virtual unsigned long long getPos();
 
 protected:
     std::ifstream *filestr;
@@ -65,7 +85,13 @@ protected:
     unsigned long long int int64; //64 bits integer
     bool skip; //set to true for ascii dxf, false for binary
 private:
+    bool reportProgress();
+
     DRW_TextCodec decoder;
+    DRW_Interface *progress;
+    unsigned long long fileSize;
+    unsigned int records; //read since the progress was reported
+    bool cancelled;
 };
 
 class dxfReaderBinary : public dxfReader {
@@ -82,10 +108,19 @@ public:
     virtual bool readBool();
 };
 
+/**
+ * Reads ascii dxf in large blocks. Group codes and values are parsed
+ * in place from the block, numbers without locale dependent streams.
+ * The stream must be opened in binary mode, lines may end in "\r\n".
+ */
 class dxfReaderAscii : public dxfReader {
 public:
-    dxfReaderAscii(std::ifstream *stream):dxfReader(stream){skip = true; }
+    dxfReaderAscii(std::ifstream *stream);
+    //reads the lines in data, which is taken over
+    dxfReaderAscii(std::vector<char> *data);
     virtual ~dxfReaderAscii(){}
+    //copies the records up to the next entity after size bytes to chunk
+    bool readSection(std::vector<char> *chunk, size_t size);
     virtual bool readCode(int *code);
     virtual bool readString(std::string *text);
     virtual bool readString();
@@ -94,6 +129,19 @@ public:
     virtual bool readInt32();
     virtual bool readInt64();
     virtual bool readBool();
+    virtual bool isGood(){return good;}
+    virtual unsigned long long getPos(){return offset + begin;}
+
+private:
+    //next line, without line end, valid until the next call
+    bool readLine(const char **line, size_t *len);
+    bool parseInt(int *value);
+
+    std::vector<char> buffer;
+    size_t begin; //start of the unread data in buffer
+    size_t end; //end of the data in buffer
+    unsigned long long offset; //offset in the file of the start of buffer
+    bool good; //false once a line ended at the end of the file
 };
 
 #endif // DXFREADER_H
@@ -0,0 +1,150 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#include "dxfreaderparallel.h"
+
+#ifdef DRW_PARALLEL_READ
+
+#include <system_error>
+
+namespace {
+//minimal size of the chunks parsed by one worker
+const size_t chunkSize = 1 << 20;
+}
+
+dxfReaderParallel::dxfReaderParallel(dxfReaderAscii *source):dxfReader(NULL),
+    source(source), maxBatches(0), sourceDone(false), stopping(false),
+    current(NULL), recordPos(0), stringPos(0), pos(0), good(true) {
+    skip = true;
+    shareSettings(source);
+}
+
+dxfReaderParallel::~dxfReaderParallel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    consumed.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+bool dxfReaderParallel::start(unsigned int threads) {
+    //parsed batches wait for the reading thread, bound their memory
+    maxBatches = 2 * threads;
+    try {
+        for (unsigned int i = 0; i < threads; ++i)
+            workers.push_back(std::thread(&dxfReaderParallel::work, this));
+    } catch (const std::system_error &) {
+        //go on with the workers started
+    }
+    return !workers.empty();
+}
+
+/**
+ * Takes the next chunk of the section from the source and parses it,
+ * until the section ended or the reader is destroyed.
+ */
+void dxfReaderParallel::work() {
+    std::vector<char> chunk;
+    for (;;) {
+        Batch *batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping && !sourceDone && batches.size() >= maxBatches)
+                consumed.wait(lock);
+            if (stopping || sourceDone)
+                return;
+            chunk.reserve(chunkSize + chunkSize / 4);
+            sourceDone = !source->readSection(&chunk, chunkSize);
+            batches.push_back(Batch());
+            batch = &batches.back();
+            batch->pos = source->getPos();
+            batch->ready = false;
+        }
+        parse(&chunk, batch);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch->ready = true;
+        }
+        parsed.notify_one();
+    }
+}
+
+void dxfReaderParallel::parse(std::vector<char> *chunk, Batch *batch) {
+    //takes over the chunk, it is empty again afterwards
+    dxfReaderAscii reader(chunk);
+    int code;
+    while (reader.readRec(&code)) {
+        Record record;
+        record.code = code;
+        record.type = reader.type;
+        record.intData = 0;
+        record.doubleData = 0.0;
+        if (reader.type == STRING)
+            batch->strings.push_back(reader.getString());
+        else if (reader.type == DOUBLE)
+            record.doubleData = reader.getDouble();
+        else
+            record.intData = reader.getInt32();
+        batch->records.push_back(record);
+    }
+}
+
+/**
+ * Drops the current batch and waits until the next one is parsed.
+ * @return false after the last batch
+ */
+bool dxfReaderParallel::nextBatch() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (current != NULL) {
+        batches.pop_front();
+        current = NULL;
+        consumed.notify_one();
+    }
+    while (batches.empty() ? !sourceDone : !batches.front().ready)
+        parsed.wait(lock);
+    if (batches.empty())
+        return false;
+    current = &batches.front();
+    recordPos = 0;
+    stringPos = 0;
+    pos = current->pos;
+    return true;
+}
+
+bool dxfReaderParallel::readCode(int *code) {
+    while (current == NULL || recordPos == current->records.size()) {
+        if (!nextBatch()) {
+            good = false;
+            return false;
+        }
+    }
+    const Record &record = current->records[recordPos++];
+    *code = record.code;
+    //only the value of this type changes, like reading the file
+    type = record.type;
+    if (type == STRING)
+        strData.swap(current->strings[stringPos++]);
+    else if (type == DOUBLE)
+        doubleData = record.doubleData;
+    else
+        intData = record.intData;
+    return true;
+}
+
+bool dxfReaderParallel::readString(std::string *text) {
+    *text = strData;
+    return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/******************************************************************************
+**  libDXFrw - Library to read/write DXF files (ascii & binary)              **
+**                                                                           **
+**  Copyright (C) 2011-2015 José F. Soriano, rallazz@gmail.com               **
+**                                                                           **
+**  This library is free software, licensed under the terms of the GNU       **
+**  General Public License as published by the Free Software Foundation,     **
+**  either version 2 of the License, or (at your option) any later version.  **
+**  You should have received a copy of the GNU General Public License        **
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
+******************************************************************************/
+
+#ifndef DXFREADERPARALLEL_H
+#define DXFREADERPARALLEL_H
+
+#include "dxfreader.h"
+
+//threads are available since C++11, older compilers read serially
+#if __cplusplus >= 201103L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201103L)
+#define DRW_PARALLEL_READ
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Reads the rest of a section of an ascii dxf with worker threads.
+ *
+ * The source reader cuts the section into chunks of whole entities,
+ * the workers parse the group codes and values of the chunks into
+ * batches of records and readRec() returns the records in the order of
+ * the file. Only the lines and numbers are parsed concurrently, the
+ * caller still builds the entities one by one.
+ */
+class dxfReaderParallel : public dxfReader {
+public:
+    dxfReaderParallel(dxfReaderAscii *source);
+    //stops and waits for the workers
+    virtual ~dxfReaderParallel();
+    //return false if no worker could be started
+    bool start(unsigned int threads);
+
+protected:
+    virtual bool readCode(int *code);
+    virtual bool readString(std::string *text);
+    //the values are set by readCode()
+    virtual bool readString(){return true;}
+    virtual bool readInt16(){return true;}
+    virtual bool readInt32(){return true;}
+    virtual bool readInt64(){return true;}
+    virtual bool readDouble(){return true;}
+    virtual bool readBool(){return true;}
+    virtual bool isGood(){return good;}
+    virtual unsigned long long getPos(){return pos;}
+
+private:
+    struct Record {
+        int code;
+        TYPE type;
+        int intData;
+        double doubleData;
+    };
+    struct Batch {
+        std::vector<Record> records;
+        std::vector<std::string> strings; //values of the STRING records
+        unsigned long long pos; //offset in the file of the end of the chunk
+        bool ready;
+    };
+
+    void work();
+    static void parse(std::vector<char> *chunk, Batch *batch);
+    bool nextBatch();
+
+    dxfReaderAscii *source;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable parsed; //a batch is ready
+    std::condition_variable consumed; //a batch was read
+    //in the order of the file, the first one is current once ready
+    std::deque<Batch> batches;
+    size_t maxBatches;
+    bool sourceDone; //the section was read to its end
+    bool stopping;
+    //used by the reading thread only
+    Batch *current;
+    size_t recordPos;
+    size_t stringPos;
+    unsigned long long pos;
+    bool good;
+};
+
+#endif
+
+#endif // DXFREADERPARALLEL_H
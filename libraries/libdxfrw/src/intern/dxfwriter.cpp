@@ -10,12 +10,130 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <cstdio>
 #include <cstdlib>
+#include <clocale>
 #include <fstream>
 #include <string>
 #include <algorithm>
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
 #include "dxfwriter.h"
 
+namespace {
+//size of the blocks written by dxfWriterAscii
+const size_t blockSize = 1 << 20;
+
+//right aligned in width characters, like operator<< of a stream
+void appendInt(std::string &out, unsigned long long value, bool negative, int width) {
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    if (negative)
+        digits[n++] = '-';
+    if (n < width)
+        out.append(width - n, ' ');
+    while (n > 0)
+        out += digits[--n];
+}
+
+void appendInt(std::string &out, int value, int width) {
+    unsigned long long magnitude = value < 0
+            ? 0ULL - static_cast<unsigned long long>(value)
+            : static_cast<unsigned long long>(value);
+    appendInt(out, magnitude, value < 0, width);
+}
+
+/**
+ * Gets the significant digits and the decimal exponent of the shortest
+ * scientific representation of value that reads back as the same
+ * double, without the sign.
+ * @return number of digits, trailing zeros removed
+ */
+int shortestDigits(double value, char *digits, int *exponent) {
+    char text[40];
+    char *end = text;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    end = std::to_chars(text, text + sizeof(text) - 1, value, std::chars_format::scientific).ptr;
+    *end = '\0';
+#else
+    //15 digits are exact for normal doubles, 17 enough for every double,
+    //printf and strtod use the same locale
+    for (int precision = value < 2.2250738585072014e-308 ? 1 : 15; precision <= 17; ++precision) {
+        end = text + snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+        if (strtod(text, NULL) == value)
+            break;
+    }
+#endif
+    int n = 0;
+    const char *p = text;
+    for (; p < end && *p != 'e'; ++p) {
+        if (*p >= '0' && *p <= '9')
+            digits[n++] = *p;
+    }
+    *exponent = p < end ? atoi(p + 1) : 0;
+    while (n > 1 && digits[n - 1] == '0')
+        --n;
+    return n;
+}
+
+/**
+ * Appends the shortest text that reads back as value, laid out like
+ * operator<< of a stream with precision 16: scientific notation for
+ * exponents below -4 and from 16 on, the decimal point independent of
+ * the locale.
+ */
+void appendDouble(std::string &out, double value) {
+    if (value != value) {
+        out += "nan";
+        return;
+    }
+    if (value < 0 || (value == 0 && 1 / value < 0)) {
+        out += '-';
+        value = -value;
+    }
+    if (value > 1.7976931348623157e308) {
+        out += "inf";
+        return;
+    }
+    char digits[24];
+    int exponent;
+    int const n = shortestDigits(value, digits, &exponent);
+    if (exponent < -4 || exponent >= 16) {
+        out += digits[0];
+        if (n > 1) {
+            out += '.';
+            out.append(digits + 1, n - 1);
+        }
+        out += 'e';
+        out += exponent < 0 ? '-' : '+';
+        int const magnitude = exponent < 0 ? -exponent : exponent;
+        if (magnitude < 10)
+            out += '0';
+        appendInt(out, magnitude, 0);
+    } else if (exponent >= 0) {
+        if (n > exponent + 1) {
+            out.append(digits, exponent + 1);
+            out += '.';
+            out.append(digits + exponent + 1, n - exponent - 1);
+        } else {
+            out.append(digits, n);
+            out.append(exponent + 1 - n, '0');
+        }
+    } else {
+        out += "0.";
+        out.append(-exponent - 1, '0');
+        out.append(digits, n);
+    }
+}
+}
+
 //RLZ TODO change std::endl to x0D x0A (13 10)
 /*bool dxfWriter::readRec(int *codeData, bool skip) {
 //    std::string text;
@@ -103,6 +221,10 @@ bool dxfWriter::writeUtf8Caps(int code, std::string text) {
     return writeString(code, t);
 }
 
+bool dxfWriter::flush() {
+    return filestr->flush().good();
+}
+
 bool dxfWriterBinary::writeString(int code, std::string text) {
     char bufcode[2];
     bufcode[0] =code & 0xFF;
@@ -215,27 +337,46 @@ bool dxfWriterBinary::writeBool(int code, bool data) {
 }
 
 dxfWriterAscii::dxfWriterAscii(std::ofstream *stream):dxfWriter(stream){
-    filestr->precision(16);
+    buffer.reserve(blockSize + 4096);
 }
 
-bool dxfWriterAscii::writeString(int code, std::string text) {
-//    *filestr << code << std::endl << text << std::endl ;
-    filestr->width(3);
-    *filestr << std::right << code << std::endl;
-    filestr->width(0);
-    *filestr << std::left << text << std::endl;
-    /*    std::getline(*filestr, strData, '\0');
-    DBG(strData); DBG("\n");*/
+dxfWriterAscii::~dxfWriterAscii(){
+    if (!buffer.empty())
+        filestr->write(buffer.data(), buffer.size());
+}
+
+bool dxfWriterAscii::flush() {
+    if (!buffer.empty()) {
+        filestr->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    return dxfWriter::flush();
+}
+
+void dxfWriterAscii::writeCode(int code, int width) {
+    appendInt(buffer, code, width);
+    buffer += '\n';
+}
+
+bool dxfWriterAscii::endLine() {
+    buffer += '\n';
+    if (buffer.size() < blockSize)
+        return true;
+    filestr->write(buffer.data(), buffer.size());
+    buffer.clear();
     return (filestr->good());
 }
 
+bool dxfWriterAscii::writeString(int code, std::string text) {
+    writeCode(code);
+    buffer += text;
+    return endLine();
+}
+
 bool dxfWriterAscii::writeInt16(int code, int data) {
-//    *filestr << std::right << code << std::endl << data << std::endl;
-    filestr->width(3);
-    *filestr << std::right << code << std::endl;
-    filestr->width(5);
-    *filestr << data << std::endl;
-    return (filestr->good());
+    writeCode(code);
+    appendInt(buffer, data, 5);
+    return endLine();
 }
 
 bool dxfWriterAscii::writeInt32(int code, int data) {
@@ -243,28 +384,20 @@ bool dxfWriterAscii::writeInt32(int code, int data) {
 }
 
 bool dxfWriterAscii::writeInt64(int code, unsigned long long int data) {
-//    *filestr << code << std::endl << data << std::endl;
-    filestr->width(3);
-    *filestr << std::right << code << std::endl;
-    filestr->width(5);
-    *filestr << data << std::endl;
-    return (filestr->good());
+    writeCode(code);
+    appendInt(buffer, data, false, 5);
+    return endLine();
 }
 
 bool dxfWriterAscii::writeDouble(int code, double data) {
-//    std::streamsize prec = filestr->precision();
-//    filestr->precision(12);
-//    *filestr << code << std::endl << data << std::endl;
-    filestr->width(3);
-    *filestr << std::right << code << std::endl;
-    *filestr << data << std::endl;
-//    filestr->precision(prec);
-    return (filestr->good());
+    writeCode(code);
+    appendDouble(buffer, data);
+    return endLine();
 }
 
 //saved as int or add a bool member??
 bool dxfWriterAscii::writeBool(int code, bool data) {
-    *filestr << code << std::endl << data << std::endl;
-    return (filestr->good());
+    writeCode(code, 0);
+    buffer += data ? '1' : '0';
+    return endLine();
 }
-
@@ -28,6 +28,8 @@ public:
     virtual bool writeInt64(int code, unsigned long long int data) = 0;
     virtual bool writeDouble(int code, double data) = 0;
     virtual bool writeBool(int code, bool data) = 0;
+    //writes buffered data and flushes the stream
+    virtual bool flush();
     void setVersion(std::string *v, bool dxfFormat){encoder.setVersion(v, dxfFormat);}
     void setCodePage(std::string *c){encoder.setCodePage(c, true);}
     std::string getCodePage(){return encoder.getCodePage();}
@@ -49,16 +51,28 @@ public:
     virtual bool writeBool(int code, bool data);
 };
 
+/**
+ * Writes ascii dxf. Lines are collected in a buffer and written to the
+ * stream in large blocks, the stream is flushed by flush() only.
+ */
 class dxfWriterAscii : public dxfWriter {
 public:
     dxfWriterAscii(std::ofstream *stream);
-    virtual ~dxfWriterAscii(){}
+    virtual ~dxfWriterAscii();
     virtual bool writeString(int code, std::string text);
     virtual bool writeInt16(int code, int data);
     virtual bool writeInt32(int code, int data);
     virtual bool writeInt64(int code, unsigned long long int data);
     virtual bool writeDouble(int code, double data);
     virtual bool writeBool(int code, bool data);
+    virtual bool flush();
+
+private:
+    void writeCode(int code, int width = 3);
+    //writes the buffer to the stream if it is full
+    bool endLine();
+
+    std::string buffer;
 };
 
 #endif // DXFWRITER_H
@@ -18,6 +18,7 @@
 #include <cassert>
 #include "intern/drw_textcodec.h"
 #include "intern/dxfreader.h"
+#include "intern/dxfreaderparallel.h"
 #include "intern/dxfwriter.h"
 #include "intern/drw_dbg.h"
 
@@ -39,6 +40,7 @@ dxfRW::dxfRW(const char* name){
     writer = NULL;
     applyExt = false;
     elParts = 128; //parts munber when convert ellipse to polyline
+    threads = 1;
 }
 dxfRW::~dxfRW(){
     if (reader != NULL)
@@ -92,11 +94,17 @@ bool dxfRW::read(DRW_Interface *interface_, bool ext){
         DRW_DBG("dxfRW::read binary file\n");
     } else {
         binFile = false;
-        filestr.open (fileName.c_str(), std::ios_base::in);
+        //line ends are handled by the reader
+        filestr.open (fileName.c_str(), std::ios_base::in | std::ios::binary);
         reader = new dxfReaderAscii(&filestr);
     }
 
-    isOk = processDxf();
+    filestr.seekg(0, std::ios::end);
+    std::streamoff fileSize = filestr.tellg();
+    filestr.seekg(binFile ? 22 : 0, std::ios::beg);
+    reader->setProgress(iface, fileSize > 0 ? fileSize : 0);
+
+    isOk = processDxf() && !reader->isCancelled();
     filestr.close();
     delete reader;
     reader = NULL;
@@ -127,33 +135,39 @@ bool dxfRW::write(DRW_Interface *interface_, DRW::Version ver, bool bin){
     entCount =FIRSTHANDLE;
     header.write(writer, version);
     writer->writeString(0, "ENDSEC");
+    writer->flush();
     if (ver > DRW::AC1009) {
         writer->writeString(0, "SECTION");
         writer->writeString(2, "CLASSES");
         writer->writeString(0, "ENDSEC");
+        writer->flush();
     }
     writer->writeString(0, "SECTION");
     writer->writeString(2, "TABLES");
     writeTables();
     writer->writeString(0, "ENDSEC");
+    writer->flush();
     writer->writeString(0, "SECTION");
     writer->writeString(2, "BLOCKS");
     writeBlocks();
     writer->writeString(0, "ENDSEC");
+    writer->flush();
 
     writer->writeString(0, "SECTION");
     writer->writeString(2, "ENTITIES");
     iface->writeEntities();
     writer->writeString(0, "ENDSEC");
+    writer->flush();
 
     if (version > DRW::AC1009) {
         writer->writeString(0, "SECTION");
         writer->writeString(2, "OBJECTS");
         writeObjects();
         writer->writeString(0, "ENDSEC");
+        writer->flush();
     }
     writer->writeString(0, "EOF");
-    filestr.flush();
+    writer->flush();
     filestr.close();
     isOk = true;
     delete writer;
@@ -1844,7 +1858,10 @@ bool dxfRW::processDxf() {
                     } else if (sectionstr == "BLOCKS") {
                         processBlocks();
                     } else if (sectionstr == "ENTITIES") {
-                        processEntities(false);
+                        if (threads > 1 && !binFile)
+                            processEntitiesParallel();
+                        else
+                            processEntities(false);
                     } else if (sectionstr == "OBJECTS") {
                         processObjects();
                     }
@@ -2114,9 +2131,9 @@ bool dxfRW::processBlock() {
                 iface->endBlock();
                 return true;  //found ENDBLK, terminate
             } else {
-                processEntities(true);
+                bool ok = processEntities(true);
                 iface->endBlock();
-                return true;  //found ENDBLK, terminate
+                return ok;  //found ENDBLK or end of file, terminate
             }
         }
         default:
@@ -2137,6 +2154,7 @@ bool dxfRW::processEntities(bool isblock) {
         return false;
     }
     bool next = true;
+    bool ok = true;
     if (code == 0) {
             nextentity = reader->getString();
     } else if (!isblock) {
@@ -2146,47 +2164,47 @@ bool dxfRW::processEntities(bool isblock) {
         if (nextentity == "ENDSEC" || nextentity == "ENDBLK") {
             return true;  //found ENDSEC or ENDBLK terminate
         } else if (nextentity == "POINT") {
-            processPoint();
+            ok = processPoint();
         } else if (nextentity == "LINE") {
-            processLine();
+            ok = processLine();
         } else if (nextentity == "CIRCLE") {
-            processCircle();
+            ok = processCircle();
         } else if (nextentity == "ARC") {
-            processArc();
+            ok = processArc();
         } else if (nextentity == "ELLIPSE") {
-            processEllipse();
+            ok = processEllipse();
         } else if (nextentity == "TRACE") {
-            processTrace();
+            ok = processTrace();
         } else if (nextentity == "SOLID") {
-            processSolid();
+            ok = processSolid();
         } else if (nextentity == "INSERT") {
-            processInsert();
+            ok = processInsert();
         } else if (nextentity == "LWPOLYLINE") {
-            processLWPolyline();
+            ok = processLWPolyline();
         } else if (nextentity == "POLYLINE") {
-            processPolyline();
+            ok = processPolyline();
         } else if (nextentity == "TEXT") {
-            processText();
+            ok = processText();
         } else if (nextentity == "MTEXT") {
-            processMText();
+            ok = processMText();
         } else if (nextentity == "HATCH") {
-            processHatch();
+            ok = processHatch();
         } else if (nextentity == "SPLINE") {
-            processSpline();
+            ok = processSpline();
         } else if (nextentity == "3DFACE") {
-            process3dface();
+            ok = process3dface();
         } else if (nextentity == "VIEWPORT") {
-            processViewport();
+            ok = processViewport();
         } else if (nextentity == "IMAGE") {
-            processImage();
+            ok = processImage();
         } else if (nextentity == "DIMENSION") {
-            processDimension();
+            ok = processDimension();
         } else if (nextentity == "LEADER") {
-            processLeader();
+            ok = processLeader();
         } else if (nextentity == "RAY") {
-            processRay();
+            ok = processRay();
         } else if (nextentity == "XLINE") {
-            processXline();
+            ok = processXline();
         } else {
             if (reader->readRec(&code)){
                 if (code == 0)
@@ -2194,9 +2212,33 @@ bool dxfRW::processEntities(bool isblock) {
             } else
                 return false; //end of file without ENDSEC
         }
-
-    } while (next);
-    return true;
+        if (!ok && !reader->isGood())
+            return false; //end of file without ENDSEC
+
+    } while (next && !reader->isCancelled());
+    return true;
+}
+
+/**
+ * Reads the ENTITIES section with the records parsed by worker threads,
+ * the entities are built here in the order of the file like serially.
+ */
+bool dxfRW::processEntitiesParallel() {
+    DRW_DBG("dxfRW::processEntitiesParallel\n");
+#ifdef DRW_PARALLEL_READ
+    dxfReader *fileReader = reader;
+    dxfReaderParallel sectionReader(static_cast<dxfReaderAscii*>(fileReader));
+    if (!sectionReader.start(threads))
+        return processEntities(false);
+    reader = &sectionReader;
+    bool ok = processEntities(false);
+    reader = fileReader;
+    if (sectionReader.isCancelled())
+        reader->cancel();
+    return ok;
+#else
+    return processEntities(false);
+#endif
 }
 
 bool dxfRW::processEllipse() {
@@ -2219,7 +2261,7 @@ bool dxfRW::processEllipse() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processTrace() {
@@ -2242,7 +2284,7 @@ bool dxfRW::processTrace() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processSolid() {
@@ -2265,7 +2307,7 @@ bool dxfRW::processSolid() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::process3dface() {
@@ -2286,7 +2328,7 @@ bool dxfRW::process3dface() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processViewport() {
@@ -2307,7 +2349,7 @@ bool dxfRW::processViewport() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processPoint() {
@@ -2328,7 +2370,7 @@ bool dxfRW::processPoint() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processLine() {
@@ -2349,7 +2391,7 @@ bool dxfRW::processLine() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processRay() {
@@ -2370,7 +2412,7 @@ bool dxfRW::processRay() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processXline() {
@@ -2391,7 +2433,7 @@ bool dxfRW::processXline() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processCircle() {
@@ -2414,7 +2456,7 @@ bool dxfRW::processCircle() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processArc() {
@@ -2437,7 +2479,7 @@ bool dxfRW::processArc() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processInsert() {
@@ -2458,7 +2500,7 @@ bool dxfRW::processInsert() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processLWPolyline() {
@@ -2481,7 +2523,7 @@ bool dxfRW::processLWPolyline() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processPolyline() {
@@ -2506,7 +2548,7 @@ bool dxfRW::processPolyline() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processVertex(DRW_Polyline *pl) {
@@ -2552,7 +2594,7 @@ bool dxfRW::processText() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processMText() {
@@ -2574,7 +2616,7 @@ bool dxfRW::processMText() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processHatch() {
@@ -2595,7 +2637,7 @@ bool dxfRW::processHatch() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 
@@ -2617,7 +2659,7 @@ bool dxfRW::processSpline() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 
@@ -2639,7 +2681,7 @@ bool dxfRW::processImage() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 
@@ -2691,7 +2733,7 @@ bool dxfRW::processDimension() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 bool dxfRW::processLeader() {
@@ -2712,7 +2754,7 @@ bool dxfRW::processLeader() {
             break;
         }
     }
-    return true;
+    return false; //end of file without ENDSEC
 }
 
 
@@ -2743,7 +2785,7 @@ bool dxfRW::processObjects() {
                 return false; //end of file without ENDSEC
         }
 
-    } while (next);
+    } while (next && !reader->isCancelled());
     return true;
 }
 
@@ -38,6 +38,13 @@ public:
      */
     bool read(DRW_Interface *interface_, bool ext);
     void setBinary(bool b) {binFile = b;}
+    /// parse the ENTITIES section of ascii files with worker threads
+    /*!
+     * The entities are still added to the interface in the order of the
+     * file, from the thread calling read().
+     * @param n number of worker threads, 0 or 1 reads serially
+     */
+    void setThreads(unsigned int n) {threads = n;}
 
     bool write(DRW_Interface *interface_, DRW::Version ver, bool bin);
     bool writeLineType(DRW_LType *ent);
@@ -79,6 +86,7 @@ private:
     bool processBlocks();
     bool processBlock();
     bool processEntities(bool isblock);
+    bool processEntitiesParallel();
     bool processObjects();
 
     bool processLType();
@@ -138,6 +146,7 @@ private:
     bool applyExt;
     bool writingBlock;
     int elParts;  /*!< parts munber when convert ellipse to polyline */
+    unsigned int threads; /*!< worker threads parsing the ENTITIES section */
     std::map<std::string,int> blockMap;
     std::vector<DRW_ImageDef*> imageDef;  /*!< imageDef list */
 
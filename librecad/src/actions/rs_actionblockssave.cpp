@@ -39,7 +39,7 @@ RS_ActionBlocksSave::RS_ActionBlocksSave(RS_EntityContainer& container,
 /*recursive add blocks in graphic*/
 void RS_ActionBlocksSave::addBlock(RS_Insert* in, RS_Graphic* g) {
 
-	for(auto e: *in){
+	for(auto e: in->getEntities()){
 
         if (e->rtti() == RS2::EntityInsert) {
 			RS_Insert * in=static_cast<RS_Insert *>(e);
@@ -481,6 +481,7 @@ void RS_ActionDrawPolyline::undo() {
             graphicView->drawEntity(polyline);
         }
         if (polyline) {
+            graphicView->deleteEntity(polyline);
             polyline->removeLastVertex();
             graphicView->moveRelativeZero(polyline->getEndpoint());
             graphicView->drawEntity(polyline);
@@ -48,20 +48,24 @@ void RS_ActionLayersToggleLock::trigger() {
 
             // deselect entities on locked layer:
             if (layer->isLocked()) {
-				for(auto e: *container){
-                    if (e && e->isVisible() && e->getLayer()==layer) {
-
-                        if (graphicView) {
-                            graphicView->deleteEntity(e);
+                std::vector<RS_Entity*> onLayer;
+                if (container==graphic) {
+                    onLayer = graphic->getLayerEntities(layer);
+                } else {
+                    for(auto e: *container){
+                        if (e && e->getLayer()==layer) {
+                            onLayer.push_back(e);
                         }
-
+                    }
+                }
+				for(auto e: onLayer){
+                    if (e->isVisible()) {
                         e->setSelected(false);
-
-                        if (graphicView) {
-                            graphicView->drawEntity(e);
-                        }
                     }
                 }
+                if (graphicView) {
+                    graphicView->redraw(RS2::RedrawDrawing);
+                }
             }
         }
 
@@ -38,6 +38,7 @@
 #include "rs_overlayline.h"
 #include "rs_coordinateevent.h"
 #include "rs_entitycontainer.h"
+#include "rs_spline.h"
 
 /**
   * Disable all snapping.
@@ -492,15 +493,21 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos,
 //    std::cout<<"getSnapRange()="<<getSnapRange()<<"\tsnap distance = "<<dist<<std::endl;
 
     RS_Entity* entity = container->getNearestEntity(pos, &dist, level);
-
-        int idx = -1;
-		if (entity && entity->getParent()) {
-                idx = entity->getParent()->findEntity(entity);
+    // the lines of splines are only created when they're caught
+    if (level!=RS2::ResolveNone && entity
+            && entity->rtti()==RS2::EntitySpline
+            && static_cast<RS_Spline*>(entity)->count()==0) {
+        RS_Spline* spline = static_cast<RS_Spline*>(entity);
+        spline->createLines();
+        if (spline->count()>0) {
+            dist = 0.;
+            entity = spline->getNearestEntity(pos, &dist, level);
         }
+    }
 
 	if (entity && dist<=getSnapRange()) {
         // highlight:
-        RS_DEBUG->print("RS_Snapper::catchEntity: found: %d", idx);
+        RS_DEBUG->print("RS_Snapper::catchEntity: found");
         return entity;
     } else {
         RS_DEBUG->print("RS_Snapper::catchEntity: not found");
@@ -22,7 +22,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 **********************************************************************/
 #include <QDebug>
 #include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "lc_rect.h"
+#include "rs_math.h"
 
 #define INTERT_TEST(s) qDebug()<<"\ntesting " #s; \
 	assert(s); \
@@ -274,6 +278,105 @@ Area(coord, {coord.x + width, coord.y + height})
 					upperRightCorner(), upperLeftCorner()};
 	}
 
+	bool LC_Rect::clip(Coordinate& p0, Coordinate& p1) const
+	{
+		return clip(p0, p1, 0., 1.);
+	}
+
+	bool LC_Rect::clipInfinite(Coordinate& p0, Coordinate& p1) const
+	{
+		if (p0.x == p1.x && p0.y == p1.y)
+			return false;
+		return clip(p0, p1, -std::numeric_limits<double>::infinity(),
+					std::numeric_limits<double>::infinity());
+	}
+
+	/**
+	 * Liang-Barsky clipping of the line p0 + t (p1 - p0), t in [t0, t1]
+	 */
+	bool LC_Rect::clip(Coordinate& p0, Coordinate& p1, double t0, double t1) const
+	{
+		double const dx = p1.x - p0.x;
+		double const dy = p1.y - p0.y;
+		// p: direction towards the boundary, q: distance to the boundary
+		auto clipBoundary = [&t0, &t1](double p, double q) {
+			if (p == 0.)
+				// parallel to the boundary
+				return q >= 0.;
+			double const r = q / p;
+			if (p < 0.) {
+				if (r > t1)
+					return false;
+				if (r > t0)
+					t0 = r;
+			} else {
+				if (r < t0)
+					return false;
+				if (r < t1)
+					t1 = r;
+			}
+			return true;
+		};
+		if (!(clipBoundary(-dx, p0.x - _minP.x)
+			  && clipBoundary(dx, _maxP.x - p0.x)
+			  && clipBoundary(-dy, p0.y - _minP.y)
+			  && clipBoundary(dy, _maxP.y - p0.y)))
+			return false;
+		if (t1 != 1.)
+			p1 = {p0.x + t1 * dx, p0.y + t1 * dy};
+		if (t0 != 0.)
+			p0 = {p0.x + t0 * dx, p0.y + t0 * dy};
+		return true;
+	}
+
+	int LC_Rect::clipEllipticArc(const Coordinate& center, const Coordinate& majorP,
+								 const Coordinate& minorP, double t0, double length,
+								 ArcSpans& spans) const
+	{
+		// the arc end points and up to two crossings with each boundary
+		std::array<double, 10> cuts;
+		int n = 0;
+		cuts[n++] = 0.;
+		cuts[n++] = length;
+		// crossings with a boundary line: a cos(t) + b sin(t) = c
+		auto addCrossings = [&](double a, double b, double c) {
+			double const r = std::hypot(a, b);
+			// missing or touching the boundary, tangent points are no cuts
+			if (!(fabs(c) < r))
+				return;
+			double const phi = std::atan2(b, a);
+			double const d = std::acos(c / r);
+			for (double t: {phi + d, phi - d}) {
+				double const dt = RS_Math::correctAngle(t - t0);
+				if (dt > 0. && dt < length)
+					cuts[n++] = dt;
+			}
+		};
+		addCrossings(majorP.x, minorP.x, _minP.x - center.x);
+		addCrossings(majorP.x, minorP.x, _maxP.x - center.x);
+		addCrossings(majorP.y, minorP.y, _minP.y - center.y);
+		addCrossings(majorP.y, minorP.y, _maxP.y - center.y);
+		std::sort(cuts.begin(), cuts.begin() + n);
+
+		// the arc is either inside or outside between two cuts
+		int count = 0;
+		for (int i = 1; i < n; ++i) {
+			double const a = cuts[i - 1];
+			double const b = cuts[i];
+			if (b <= a)
+				continue;
+			double const t = t0 + 0.5 * (a + b);
+			if (!inArea(center + majorP * std::cos(t) + minorP * std::sin(t)))
+				continue;
+			if (count > 0 && (spans[count - 1].second == a
+							  || count == int(spans.size())))
+				spans[count - 1].second = b;
+			else
+				spans[count++] = {a, b};
+		}
+		return count;
+	}
+
 	std::ostream& operator<<(std::ostream& os, const Area& area) {
 		os << "Area(" << area.minP() << " " << area.maxP() << ")";
 		return os;
@@ -304,5 +407,35 @@ void LC_Rect::unitTest() {
 	INTERT_TEST(!rect0.inArea({1.1, 1.1}))
 	INTERT_TEST(!rect0.inArea({-1.1, -1.1}))
 
+	// clip() tests
+	Coordinate p0{-1., 0.5}, p1{2., 0.5};
+	INTERT_TEST(rect0.clip(p0, p1))
+	INTERT_TEST(p0 == Coordinate(0., 0.5) && p1 == Coordinate(1., 0.5))
+	p0 = {0.2, 0.2}; p1 = {0.8, 0.8};
+	INTERT_TEST(rect0.clip(p0, p1))
+	INTERT_TEST(p0 == Coordinate(0.2, 0.2) && p1 == Coordinate(0.8, 0.8))
+	p0 = {2., 0.}; p1 = {0., 2.5};
+	INTERT_TEST(!rect0.clip(p0, p1))
+	p0 = {0.25, 0.5}; p1 = {0.75, 0.5};
+	INTERT_TEST(rect0.clipInfinite(p0, p1))
+	INTERT_TEST(p0 == Coordinate(0., 0.5) && p1 == Coordinate(1., 0.5))
+	p0 = {0.5, 2.}; p1 = {1.5, 2.};
+	INTERT_TEST(!rect0.clipInfinite(p0, p1))
+
+	// clipEllipticArc() tests
+	ArcSpans spans;
+	// unit circle around a corner: the quarter within the area is visible
+	INTERT_TEST(rect0.clipEllipticArc({0., 0.}, {0.5, 0.}, {0., 0.5},
+									  0., 2.*M_PI, spans) == 1)
+	INTERT_TEST(fabs(spans[0].first) < RS_TOLERANCE
+				&& fabs(spans[0].second - M_PI_2) < RS_TOLERANCE)
+	// circle fully within the area
+	INTERT_TEST(rect0.clipEllipticArc({0.5, 0.5}, {0.25, 0.}, {0., 0.25},
+									  0., 2.*M_PI, spans) == 1)
+	INTERT_TEST(spans[0].first == 0. && spans[0].second == 2.*M_PI)
+	// arc outside of the area
+	INTERT_TEST(rect0.clipEllipticArc({0.5, 0.5}, {2., 0.}, {0., 2.},
+									  0., M_PI, spans) == 0)
+
 }
 
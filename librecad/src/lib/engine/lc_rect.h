@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #define LC_RECT_H
 #include "rs_vector.h"
 #include <array>
+#include <utility>
 
 //ported from LibreCAD V3
 namespace lc {
@@ -200,10 +201,42 @@ public:
 	 */
 	std::array<Coordinate, 4> vertices() const;
 
+	/**
+	 * @brief clip clips the line segment p0-p1 to this area in place
+	 * (Liang-Barsky), the direction of the segment is kept
+	 * @return false, if no part of the segment is within the area
+	 */
+	bool clip(Coordinate& p0, Coordinate& p1) const;
+
+	/**
+	 * @brief clipInfinite clips the infinite line through p0 and p1 to
+	 * this area, p0 and p1 are replaced by the end points of the visible
+	 * part in the direction from p0 to p1
+	 * @return false, if the line misses the area or p0 and p1 coincide
+	 */
+	bool clipInfinite(Coordinate& p0, Coordinate& p1) const;
+
+	//! visible parameter intervals of an elliptic arc, see clipEllipticArc()
+	typedef std::array<std::pair<double, double>, 5> ArcSpans;
+
+	/**
+	 * @brief clipEllipticArc finds the parts of the elliptic arc
+	 * center + majorP cos(t) + minorP sin(t), t from t0 to t0 + length,
+	 * within this area. Circular arcs have orthogonal majorP and minorP
+	 * of the radius length.
+	 * @param spans receives the visible intervals, as offsets from t0 in
+	 * increasing order
+	 * @return number of intervals in spans
+	 */
+	int clipEllipticArc(const Coordinate& center, const Coordinate& majorP,
+						const Coordinate& minorP, double t0, double length,
+						ArcSpans& spans) const;
+
 	static void unitTest();
 
 private:
 	static Coordinate Vector(Coordinate const& p, Coordinate const& q);
+	bool clip(Coordinate& p0, Coordinate& p1, double t0, double t1) const;
 	friend std::ostream& operator<<(std::ostream& os, const Area& area);
 
 private:
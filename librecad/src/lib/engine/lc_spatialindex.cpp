@@ -0,0 +1,246 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "lc_spatialindex.h"
+#include "rs_entitycontainer.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+namespace {
+typedef bg::model::point<double, 2, bg::cs::cartesian> IndexPoint;
+typedef bg::model::box<IndexPoint> IndexBox;
+typedef std::pair<IndexBox, RS_Entity*> IndexValue;
+typedef bgi::rtree<IndexValue, bgi::rstar<16> > IndexTree;
+
+void mergePickPoints(const RS_Entity* entity, IndexBox& box)
+{
+	// entities can be picked by their center point, which is not always
+	// within the borders (arcs), see RS_Entity::getDistanceToPoint()
+	RS_Vector const& center = entity->getCenter();
+	if (center.valid)
+		bg::expand(box, IndexPoint{center.x, center.y});
+	if (entity->isContainer())
+		for (RS_Entity const* e: *static_cast<RS_EntityContainer const*>(entity))
+			mergePickPoints(e, box);
+}
+
+/**
+ * @brief entityBox box used to index an entity: its borders and the
+ * points the entity can be picked by
+ * @return false, if the entity has no finite box
+ */
+bool entityBox(const RS_Entity* entity, IndexBox& box)
+{
+	if (entity->rtti() == RS2::EntityConstructionLine)
+		return false;
+	RS_Vector const& vMin = entity->getMin();
+	RS_Vector const& vMax = entity->getMax();
+	if (!(vMin.valid && vMax.valid && vMin.x <= vMax.x && vMin.y <= vMax.y))
+		return false;
+	box = IndexBox{{vMin.x, vMin.y}, {vMax.x, vMax.y}};
+	mergePickPoints(entity, box);
+	IndexPoint const& low = box.min_corner();
+	IndexPoint const& high = box.max_corner();
+	return bg::get<0>(low) >= RS_MINDOUBLE && bg::get<1>(low) >= RS_MINDOUBLE
+			&& bg::get<0>(high) <= RS_MAXDOUBLE && bg::get<1>(high) <= RS_MAXDOUBLE;
+}
+}
+
+struct LC_SpatialIndex::Impl {
+	IndexTree tree;
+	//! boxes as inserted, needed to remove values from the tree
+	std::unordered_map<RS_Entity*, IndexBox> boxes;
+	//! entities not stored in the tree
+	std::vector<RS_Entity*> unbounded;
+};
+
+// the tree is only allocated by build(): most containers are never indexed
+LC_SpatialIndex::LC_SpatialIndex() = default;
+
+LC_SpatialIndex::LC_SpatialIndex(const LC_SpatialIndex&)
+{
+}
+
+LC_SpatialIndex& LC_SpatialIndex::operator = (const LC_SpatialIndex& rhs)
+{
+	if (this != &rhs)
+		clear();
+	return *this;
+}
+
+LC_SpatialIndex::~LC_SpatialIndex() = default;
+
+bool LC_SpatialIndex::isBounded(const RS_Entity* entity)
+{
+	IndexBox box;
+	return entityBox(entity, box);
+}
+
+void LC_SpatialIndex::build(const std::vector<RS_Entity*>& entities)
+{
+	pImpl.reset(new Impl{});
+	std::vector<IndexValue> values;
+	values.reserve(entities.size());
+	for (RS_Entity* e: entities) {
+		IndexBox box;
+		if (entityBox(e, box)) {
+			pImpl->boxes.emplace(e, box);
+			values.emplace_back(box, e);
+		} else {
+			pImpl->unbounded.push_back(e);
+		}
+	}
+	// packing constructor: much faster than inserting one by one
+	IndexTree tree(values.begin(), values.end());
+	pImpl->tree.swap(tree);
+}
+
+void LC_SpatialIndex::insert(RS_Entity* entity)
+{
+	if (!entity || !pImpl || pImpl->boxes.count(entity))
+		return;
+	IndexBox box;
+	if (entityBox(entity, box)) {
+		pImpl->boxes.emplace(entity, box);
+		pImpl->tree.insert(IndexValue(box, entity));
+	} else if (std::find(pImpl->unbounded.begin(), pImpl->unbounded.end(), entity)
+			   == pImpl->unbounded.end()) {
+		pImpl->unbounded.push_back(entity);
+	}
+}
+
+bool LC_SpatialIndex::remove(RS_Entity* entity)
+{
+	if (!pImpl)
+		return false;
+	auto it = pImpl->boxes.find(entity);
+	if (it != pImpl->boxes.end()) {
+		pImpl->tree.remove(IndexValue(it->second, entity));
+		pImpl->boxes.erase(it);
+		return true;
+	}
+	auto itU = std::find(pImpl->unbounded.begin(), pImpl->unbounded.end(), entity);
+	if (itU != pImpl->unbounded.end()) {
+		pImpl->unbounded.erase(itU);
+		return true;
+	}
+	return false;
+}
+
+bool LC_SpatialIndex::update(RS_Entity* entity)
+{
+	if (!remove(entity))
+		return false;
+	insert(entity);
+	return true;
+}
+
+bool LC_SpatialIndex::refresh(RS_Entity* entity)
+{
+	if (!pImpl)
+		return false;
+	IndexBox box;
+	bool const bounded = entityBox(entity, box);
+	auto it = pImpl->boxes.find(entity);
+	if (it != pImpl->boxes.end() ? bounded && bg::equals(box, it->second) : !bounded)
+		return false;
+	return update(entity);
+}
+
+void LC_SpatialIndex::clear()
+{
+	pImpl.reset();
+}
+
+bool LC_SpatialIndex::isValid() const
+{
+	return pImpl != nullptr;
+}
+
+size_t LC_SpatialIndex::size() const
+{
+	return pImpl ? pImpl->boxes.size() + pImpl->unbounded.size() : 0;
+}
+
+bool LC_SpatialIndex::isEmpty() const
+{
+	return size() == 0;
+}
+
+std::vector<RS_Entity*> LC_SpatialIndex::queryRect(const LC_Rect& area) const
+{
+	if (!pImpl)
+		return {};
+	std::vector<RS_Entity*> ret(pImpl->unbounded);
+	IndexBox const box{{area.minP().x, area.minP().y},
+		{area.maxP().x, area.maxP().y}};
+	std::vector<IndexValue> found;
+	pImpl->tree.query(bgi::intersects(box), std::back_inserter(found));
+	ret.reserve(ret.size() + found.size());
+	for (IndexValue const& v: found)
+		ret.push_back(v.second);
+	return ret;
+}
+
+std::vector<RS_Entity*> LC_SpatialIndex::queryNearest(const RS_Vector& coord,
+														 unsigned k) const
+{
+	std::vector<RS_Entity*> ret;
+	if (!k) return ret;
+	ret.reserve(k);
+	visitNearest(coord, [&ret, k](RS_Entity* e, double) {
+		ret.push_back(e);
+		return ret.size() < k;
+	});
+	return ret;
+}
+
+void LC_SpatialIndex::visitNearest(const RS_Vector& coord,
+								   std::function<bool(RS_Entity*, double)> const& visitor) const
+{
+	if (!pImpl)
+		return;
+	for (RS_Entity* e: pImpl->unbounded)
+		if (!visitor(e, 0.))
+			return;
+
+	if (pImpl->tree.empty())
+		return;
+
+	IndexPoint const point{coord.x, coord.y};
+	// incremental query: the tree is traversed lazily, so stopping early
+	// only pays for the visited entities
+	for (auto it = pImpl->tree.qbegin(bgi::nearest(point, pImpl->tree.size()));
+		 it != pImpl->tree.qend(); ++it) {
+		if (!visitor(it->second, bg::distance(point, it->first)))
+			return;
+	}
+}
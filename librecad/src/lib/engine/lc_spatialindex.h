@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_SPATIALINDEX_H
+#define LC_SPATIALINDEX_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "lc_rect.h"
+
+class RS_Entity;
+
+/**
+ * R-tree of entity bounding boxes, used by RS_EntityContainer to answer
+ * window and nearest entity queries without visiting every entity.
+ *
+ * The index stores the bounding box an entity had when it was inserted,
+ * so entities must be removed before their borders change and inserted
+ * again afterwards (see update()).
+ *
+ * Entities without finite borders (construction lines, empty
+ * containers, entities with reset borders) are kept in a separate list
+ * and are returned by every query.
+ *
+ * An index is valid from build() until clear(). Copies of an index are
+ * empty and invalid: an index belongs to one container and is rebuilt
+ * on demand by a copied container.
+ */
+class LC_SpatialIndex {
+public:
+	LC_SpatialIndex();
+	LC_SpatialIndex(const LC_SpatialIndex&);
+	LC_SpatialIndex& operator = (const LC_SpatialIndex&);
+	~LC_SpatialIndex();
+
+	/** Replaces the content by the given entities, using bulk loading */
+	void build(const std::vector<RS_Entity*>& entities);
+	void insert(RS_Entity* entity);
+	bool remove(RS_Entity* entity);
+	/**
+	 * re-reads the borders of an entity already in the index
+	 * @return false, if the entity is not in the index
+	 */
+	bool update(RS_Entity* entity);
+	/**
+	 * re-reads the borders of an entity in the index if they changed
+	 * without update() being called
+	 * @return true, if the box of the entity changed
+	 */
+	bool refresh(RS_Entity* entity);
+	/** empties the index and marks it invalid */
+	void clear();
+	bool isValid() const;
+
+	size_t size() const;
+	bool isEmpty() const;
+
+	/**
+	 * @brief queryRect entities whose bounding box intersects with area
+	 * @return candidate entities, unsorted
+	 */
+	std::vector<RS_Entity*> queryRect(const LC_Rect& area) const;
+
+	/**
+	 * @brief queryNearest k entities with bounding boxes closest to coord
+	 * @return candidate entities, unbounded entities first, then by
+	 * increasing bounding box distance
+	 */
+	std::vector<RS_Entity*> queryNearest(const RS_Vector& coord, unsigned k) const;
+
+	/**
+	 * @brief visitNearest visits entities by increasing bounding box distance
+	 * to coord. Unbounded entities are visited first with a distance of 0.
+	 * @param visitor called with the entity and the distance from coord to
+	 * its bounding box, returns false to stop the traversal
+	 */
+	void visitNearest(const RS_Vector& coord,
+					  std::function<bool(RS_Entity*, double)> const& visitor) const;
+
+	/** whether the entity can be stored in the tree */
+	static bool isBounded(const RS_Entity* entity);
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> pImpl;
+};
+
+#endif // LC_SPATIALINDEX_H
@@ -286,7 +286,7 @@ LC_SplinePoints::LC_SplinePoints(RS_EntityContainer* parent,
 	RS_AtomicEntity(parent)
   ,data(d)
 {
-	calculateBorders();
+	update();
 }
 
 RS_Entity* LC_SplinePoints::clone() const
@@ -1124,6 +1124,7 @@ bool LC_SplinePoints::addPoint(const RS_Vector& v)
 		(v - data.splinePoints.back()).squared() > RS_TOLERANCE2)
 	{
 		data.splinePoints.push_back(v);
+		update();
 		return true;
 	}
 	return false;
@@ -1135,6 +1136,7 @@ bool LC_SplinePoints::addPoint(const RS_Vector& v)
 void LC_SplinePoints::removeLastPoint()
 {
 	data.splinePoints.pop_back();
+	update();
 }
 
 void LC_SplinePoints::addControlPoint(const RS_Vector& v)
@@ -1598,13 +1600,9 @@ void LC_SplinePoints::drawPattern(RS_Painter* painter, RS_GraphicView* view,
 	size_t n = data.controlPoints.size();
 	if(n < 2) return;
 
-	double dpmm = static_cast<RS_PainterQt*>(painter)->getDpmm();
-	std::vector<double> ds(size_t(pat->num), 0.);
-	for(size_t i = 0; i < pat->num; i++)
-	{
-		ds[i] = dpmm*pat->pattern[i];
-		if(fabs(ds[i]) < 1.0) ds[i] = (ds[i] >= 0.0) ? 1.0 : -1.0;
-	}
+	double dpmm = painter->getDpmm();
+	// pattern in pixels, shared by all splines of the view
+	std::vector<double> const& ds = view->getDashPattern(pat, painter).dashes;
 
 	RS_Vector vStart = data.controlPoints.at(0);
 	RS_Vector vControl(false), vEnd(false);
@@ -1796,6 +1794,15 @@ void LC_SplinePoints::drawSimple(RS_Painter* painter, RS_GraphicView* view)
 	painter->drawPath(qPath);
 }
 
+/**
+ * Control points of splines whose data was changed directly, see getData(),
+ * are updated before drawing.
+ */
+void LC_SplinePoints::prepareDrawing(RS_GraphicView* /*view*/)
+{
+	update();
+}
+
 void LC_SplinePoints::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset)
 {
 	if(painter == NULL || view == NULL)
@@ -1825,8 +1832,6 @@ void LC_SplinePoints::draw(RS_Painter* painter, RS_GraphicView* view, double& pa
 			"RS_Line::draw: Invalid line pattern");
 	}
 
-	update();
-
     // Pen to draw pattern is always solid:
     RS_Pen pen = painter->getPen();
     pen.setLineType(RS2::SolidLine);
@@ -212,6 +212,7 @@ public:
 	virtual void revertDirection();
 
 	virtual void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset);
+	virtual void prepareDrawing(RS_GraphicView* view);
     std::vector<RS_Vector> const& getPoints() const;
     std::vector<RS_Vector> const& getControlPoints() const;
     std::vector<RS_Vector> getStrokePoints() const;
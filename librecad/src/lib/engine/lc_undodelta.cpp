@@ -0,0 +1,288 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+
+#include "lc_undodelta.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_ellipse.h"
+#include "rs_entitycontainer.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_line.h"
+#include "rs_point.h"
+
+namespace {
+/**
+ * Updates what depends on the geometry of an entity changed in place:
+ * the block reference of inserts and the spatial index of the parent.
+ * The borders of the parent containers are refreshed once for all
+ * entities by the document.
+ */
+void entityChanged(RS_Entity* entity)
+{
+	if (entity->rtti()==RS2::EntityInsert)
+		static_cast<RS_Insert*>(entity)->update();
+	RS_EntityContainer* parent = entity->getParent();
+	if (parent) {
+		parent->invalidateBorders();
+		parent->updateSpatialIndex(entity);
+	}
+}
+
+template<class T, class F>
+void eraseIf(std::vector<T>& v, F pred)
+{
+	v.erase(std::remove_if(v.begin(), v.end(), pred), v.end());
+}
+
+/** recalculates what an entity derives from its data */
+void dataChanged(RS_Entity* entity)
+{
+	entity->calculateBorders();
+}
+
+void dataChanged(RS_Arc* arc)
+{
+	arc->calculateEndpoints();
+	arc->calculateBorders();
+}
+
+void dataChanged(RS_Insert*)
+{
+	// rebuilt by entityChanged()
+}
+}
+
+/**
+ * The data of one entity before (state 0) and after (state 1) the
+ * transformation. Both states are initialized to the current data.
+ */
+class LC_TransformDelta::Snapshot {
+public:
+	virtual ~Snapshot() = default;
+
+	virtual RS_Entity* getEntity() const = 0;
+	virtual void record(int state) = 0;
+	virtual void restore(int state) = 0;
+	virtual size_t memoryUsage() const = 0;
+};
+
+namespace {
+template<class E, class D>
+class DataSnapshot : public LC_TransformDelta::Snapshot {
+public:
+	DataSnapshot(E* entity):
+		entity(entity)
+	  , data{entity->getData(), entity->getData()}
+	{
+	}
+
+	RS_Entity* getEntity() const override
+	{
+		return entity;
+	}
+
+	void record(int state) override
+	{
+		data[state] = entity->getData();
+	}
+
+	void restore(int state) override
+	{
+		entity->setData(data[state]);
+		dataChanged(entity);
+	}
+
+	size_t memoryUsage() const override
+	{
+		return sizeof(*this);
+	}
+
+private:
+	E* entity;
+	D data[2];
+};
+
+template<class E, class D>
+std::unique_ptr<LC_TransformDelta::Snapshot> makeSnapshot(RS_Entity* entity)
+{
+	return std::unique_ptr<LC_TransformDelta::Snapshot>(
+				new DataSnapshot<E, D>(static_cast<E*>(entity)));
+}
+
+/**
+ * @return nullptr for entities that keep geometry outside of their data
+ *	(e.g. polylines, hatches) or adjust it when transformed (e.g. texts
+ *	that stay readable when mirrored, dimensions).
+ */
+std::unique_ptr<LC_TransformDelta::Snapshot> makeSnapshot(RS_Entity* entity)
+{
+	switch (entity->rtti()) {
+	case RS2::EntityPoint:
+		return makeSnapshot<RS_Point, RS_PointData>(entity);
+	case RS2::EntityLine:
+		return makeSnapshot<RS_Line, RS_LineData>(entity);
+	case RS2::EntityArc:
+		return makeSnapshot<RS_Arc, RS_ArcData>(entity);
+	case RS2::EntityCircle:
+		return makeSnapshot<RS_Circle, RS_CircleData>(entity);
+	case RS2::EntityEllipse:
+		return makeSnapshot<RS_Ellipse, RS_EllipseData>(entity);
+	case RS2::EntityInsert:
+		return makeSnapshot<RS_Insert, RS_InsertData>(entity);
+	default:
+		return nullptr;
+	}
+}
+}
+
+LC_TransformDelta::LC_TransformDelta(Type type, const RS_Vector& v1,
+									 const RS_Vector& v2, double angle):
+	type(type)
+  , v1(v1)
+  , v2(v2)
+  , angle(angle)
+{
+}
+
+LC_TransformDelta::~LC_TransformDelta() = default;
+
+bool LC_TransformDelta::transform(RS_Entity* entity)
+{
+	std::unique_ptr<Snapshot> snapshot = makeSnapshot(entity);
+	if (!snapshot)
+		return false;
+	apply(entity);
+	snapshot->record(1);
+	snapshots.push_back(std::move(snapshot));
+	return true;
+}
+
+bool LC_TransformDelta::isEmpty() const
+{
+	return snapshots.empty();
+}
+
+void LC_TransformDelta::apply(RS_Entity* entity) const
+{
+	switch (type) {
+	case Move:
+		entity->move(v1);
+		break;
+	case Rotate:
+		entity->rotate(v1, angle);
+		break;
+	case Scale:
+		entity->scale(v1, v2);
+		break;
+	case Mirror:
+		entity->mirror(v1, v2);
+		break;
+	}
+	entityChanged(entity);
+}
+
+void LC_TransformDelta::restore(int state)
+{
+	for (auto const& s: snapshots) {
+		s->restore(state);
+		entityChanged(s->getEntity());
+	}
+}
+
+void LC_TransformDelta::undo()
+{
+	restore(0);
+}
+
+void LC_TransformDelta::redo()
+{
+	restore(1);
+}
+
+void LC_TransformDelta::removeEntities(const std::set<RS_Undoable*>& removed)
+{
+	eraseIf(snapshots, [&removed](std::unique_ptr<Snapshot> const& s) {
+		return removed.count(s->getEntity()) > 0;
+	});
+}
+
+size_t LC_TransformDelta::memoryUsage() const
+{
+	size_t size = sizeof(*this)
+			+ snapshots.capacity()*sizeof(std::unique_ptr<Snapshot>);
+	for (auto const& s: snapshots)
+		size += s->memoryUsage();
+	return size;
+}
+
+void LC_AttributesDelta::addEntity(RS_Entity* entity)
+{
+	RS_Layer* layer = entity->getLayer(false);
+	RS_Pen const pen = entity->getPen(false);
+	changes.push_back(Change{entity, {layer, layer}, {pen, pen}});
+}
+
+void LC_AttributesDelta::finish()
+{
+	for (Change& c: changes) {
+		c.layer[1] = c.entity->getLayer(false);
+		c.pen[1] = c.entity->getPen(false);
+	}
+}
+
+bool LC_AttributesDelta::isEmpty() const
+{
+	return changes.empty();
+}
+
+void LC_AttributesDelta::apply(int state)
+{
+	for (Change& c: changes) {
+		c.entity->setLayer(c.layer[state]);
+		c.entity->setPen(c.pen[state]);
+		c.entity->update();
+	}
+}
+
+void LC_AttributesDelta::undo()
+{
+	apply(0);
+}
+
+void LC_AttributesDelta::redo()
+{
+	apply(1);
+}
+
+void LC_AttributesDelta::removeEntities(const std::set<RS_Undoable*>& removed)
+{
+	eraseIf(changes, [&removed](Change const& c) {
+		return removed.count(c.entity) > 0;
+	});
+}
+
+size_t LC_AttributesDelta::memoryUsage() const
+{
+	return sizeof(*this) + changes.capacity()*sizeof(Change);
+}
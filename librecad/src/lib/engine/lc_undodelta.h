@@ -0,0 +1,138 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_UNDODELTA_H
+#define LC_UNDODELTA_H
+
+#include <memory>
+#include <set>
+#include <vector>
+#include "rs_pen.h"
+#include "rs_vector.h"
+
+class RS_Entity;
+class RS_Layer;
+class RS_Undoable;
+
+/**
+ * A change recorded by an undo cycle as a difference instead of copies
+ * of the affected entities. The entities are modified in place and the
+ * delta applies the change backwards (undo) or forwards (redo).
+ *
+ * @see RS_UndoCycle
+ */
+class LC_UndoDelta {
+public:
+	virtual ~LC_UndoDelta() = default;
+
+	virtual void undo() = 0;
+	virtual void redo() = 0;
+	/** drops entities that are about to be deleted */
+	virtual void removeEntities(const std::set<RS_Undoable*>& entities) = 0;
+	/** @return estimated heap memory held by the delta in bytes */
+	virtual size_t memoryUsage() const = 0;
+};
+
+/**
+ * A geometric transformation applied to a set of entities. The defining
+ * data of each entity is recorded before and after the transformation
+ * and restored by undo and redo, so undo cycles never accumulate
+ * rounding errors. Only entities whose data fully describes their
+ * geometry can be transformed this way, others have to be copied.
+ */
+class LC_TransformDelta : public LC_UndoDelta {
+public:
+	enum Type {
+		Move,	/**< v1: offset */
+		Rotate, /**< v1: center, angle: rotation angle */
+		Scale,	/**< v1: center, v2: scale factors, none of them 0 */
+		Mirror	/**< v1, v2: axis points */
+	};
+
+	LC_TransformDelta(Type type, const RS_Vector& v1,
+					  const RS_Vector& v2 = RS_Vector(false),
+					  double angle = 0.);
+	~LC_TransformDelta();
+
+	/**
+	 * Transforms entity in place and records its data before and after.
+	 *
+	 * @return false: entity can't be restored from its data and is left
+	 *	unchanged.
+	 */
+	bool transform(RS_Entity* entity);
+	bool isEmpty() const;
+
+	void undo() override;
+	void redo() override;
+	void removeEntities(const std::set<RS_Undoable*>& entities) override;
+	size_t memoryUsage() const override;
+
+	/** transforms entity in place without recording it */
+	void apply(RS_Entity* entity) const;
+
+	/** recorded data of one entity */
+	class Snapshot;
+
+private:
+	void restore(int state);
+
+	Type type;
+	RS_Vector v1;
+	RS_Vector v2;
+	double angle;
+	std::vector<std::unique_ptr<Snapshot>> snapshots;
+};
+
+/**
+ * Layer and pen changes of a set of entities.
+ */
+class LC_AttributesDelta : public LC_UndoDelta {
+public:
+	/**
+	 * Records the current layer and pen of entity as the state before the
+	 * change. Must be called before the attributes are changed.
+	 */
+	void addEntity(RS_Entity* entity);
+	/**
+	 * Records the current layer and pen of all entities as the state
+	 * after the change.
+	 */
+	void finish();
+	bool isEmpty() const;
+
+	void undo() override;
+	void redo() override;
+	void removeEntities(const std::set<RS_Undoable*>& entities) override;
+	size_t memoryUsage() const override;
+
+private:
+	struct Change {
+		RS_Entity* entity;
+		RS_Layer* layer[2];
+		RS_Pen pen[2];
+	};
+	void apply(int state);
+
+	std::vector<Change> changes;
+};
+
+#endif // LC_UNDODELTA_H
@@ -917,6 +917,8 @@ public:
                 RedrawGrid = 1,
                 RedrawOverlay = 2,
                 RedrawDrawing = 4,
+                // the view was panned or zoomed, the drawing is unchanged
+                RedrawView = RedrawGrid | RedrawOverlay,
                 RedrawAll = 0xffff
         };
 
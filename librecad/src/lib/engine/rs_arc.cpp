@@ -35,7 +35,7 @@
 #include "rs_graphicview.h"
 #include "rs_painter.h"
 #include "lc_quadratic.h"
-#include "rs_painterqt.h"
+#include "lc_rect.h"
 
 
 #ifdef EMU_C99
@@ -890,57 +890,52 @@ void RS_Arc::stretch(const RS_Vector& firstCorner,
 void RS_Arc::draw(RS_Painter* painter, RS_GraphicView* view,
                   double& patternOffset) {
 	if (!( painter && view)) return;
+	drawClipped(this, painter, view, getCenter(), getRadius(),
+				isReversed()?getAngle2():getAngle1(), getAngleLength(),
+				patternOffset);
+}
 
-    //only draw the visible portion of line
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
-    QPolygonF visualBox(QRectF(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y));
-
-    RS_Vector vpStart(isReversed()?getEndpoint():getStartpoint());
-    RS_Vector vpEnd(isReversed()?getStartpoint():getEndpoint());
-
-	std::vector<RS_Vector> vertex(0);
-    for(unsigned short i=0;i<4;i++){
-        const QPointF& vp(visualBox.at(i));
-		vertex.push_back(RS_Vector(vp.x(),vp.y()));
-    }
-    /** angles at cross points */
-	std::vector<double> crossPoints(0);
-
-    double baseAngle=isReversed()?getAngle2():getAngle1();
-    for(unsigned short i=0;i<4;i++){
-		RS_Line line{vertex.at(i),vertex.at((i+1)%4)};
-		auto vpIts=RS_Information::getIntersection(
-                    static_cast<RS_Entity*>(this),
-                    &line,
-                    true);
-        if( vpIts.size()==0) continue;
-		for(const RS_Vector& vp: vpIts){
-			auto ap1=getTangentDirection(vp).angle();
-			auto ap2=line.getTangentDirection(vp).angle();
-            //ignore tangent points, because the arc doesn't cross over
-            if( fabs( remainder(ap2 - ap1, M_PI) ) < RS_TOLERANCE_ANGLE) continue;
-            crossPoints.push_back(
-                        RS_Math::getAngleDifference(baseAngle, getCenter().angleTo(vp))
-                        );
-        }
-    }
-    if(vpStart.isInWindowOrdered(vpMin, vpMax)) crossPoints.push_back(0.);
-    if(vpEnd.isInWindowOrdered(vpMin, vpMax)) crossPoints.push_back(getAngleLength());
-
-    //sorting
-    std::sort(crossPoints.begin(),crossPoints.end());
-    //draw visible
-    RS_Arc arc(*this);
-    arc.setPen(getPen());
-    arc.setSelected(isSelected());
-    arc.setReversed(false);
-	for(size_t i=1;i<crossPoints.size();i+=2){
-		arc.setAngle1(baseAngle+crossPoints[i-1]);
-		arc.setAngle2(baseAngle+crossPoints[i]);
-        arc.drawVisible(painter,view,patternOffset);
-    }
+/**
+ * Draws the visible parts of a circular arc, counter-clockwise from
+ * baseAngle, with the pen and selection state of entity.
+ */
+void RS_Arc::drawClipped(const RS_Entity* entity, RS_Painter* painter,
+						 RS_GraphicView* view, const RS_Vector& center,
+						 double radius, double baseAngle, double angleLength,
+						 double& patternOffset) {
+	//only draw the visible portion of the arc
+	LC_Rect const viewportRect{view->toGraph(0, view->getHeight()),
+				view->toGraph(view->getWidth(), 0)};
+	// early accept and reject by the borders
+	RS_Vector const& vMin = entity->getMin();
+	RS_Vector const& vMax = entity->getMax();
+	if (vMin.valid && vMax.valid && vMin.x <= vMax.x && vMin.y <= vMax.y) {
+		LC_Rect const box{vMin, vMax};
+		if (!viewportRect.intersects(box)) {
+			patternOffset -= radius*view->getFactor().x*angleLength;
+			return;
+		}
+		if (box.inArea(viewportRect)) {
+			drawSpan(entity, painter, view, center, radius,
+					 baseAngle, baseAngle + angleLength, patternOffset);
+			return;
+		}
+	}
 
+	LC_Rect::ArcSpans spans;
+	int const n = viewportRect.clipEllipticArc(center, {radius, 0.}, {0., radius},
+											   baseAngle, angleLength, spans);
+	// the pattern starts at the arc start, not at the view border: the
+	// offset of each span is chosen for drawSpan() to continue it
+	double const ra = radius*view->getFactor().x;
+	double const endOffset = patternOffset - ra*angleLength;
+	for (int i = 0; i < n; ++i) {
+		double spanOffset = endOffset + ra*(spans[i].second - 2.*spans[i].first);
+		drawSpan(entity, painter, view, center, radius,
+				 baseAngle + spans[i].first, baseAngle + spans[i].second,
+				 spanOffset);
+	}
+	patternOffset = endOffset;
 }
 
 /** directly draw the arc, assuming the whole arc is within visible window */
@@ -951,20 +946,30 @@ void RS_Arc::drawVisible(RS_Painter* painter, RS_GraphicView* view,
     //visible in grahic view
     if(isVisibleInWindow(view)==false) return;
 
-    RS_Vector cp=view->toGui(getCenter());
-    double ra=getRadius()*view->getFactor().x;
-    double length=getLength()*view->getFactor().x;
+	double const baseAngle = isReversed()?getAngle2():getAngle1();
+	drawSpan(this, painter, view, getCenter(), getRadius(),
+			 baseAngle, baseAngle + getAngleLength(), patternOffset);
+}
+
+/**
+ * Draws the arc from a1 to a2 counter-clockwise, with the pen and
+ * selection state of entity.
+ */
+void RS_Arc::drawSpan(const RS_Entity* entity, RS_Painter* painter,
+					  RS_GraphicView* view, const RS_Vector& center,
+					  double radius, double a1, double a2,
+					  double& patternOffset) {
+    RS_Vector cp=view->toGui(center);
+    double ra=radius*view->getFactor().x;
+    double length=radius*(a2 - a1)*view->getFactor().x;
     //double styleFactor = getStyleFactor();
     patternOffset -= length;
 
     // simple style-less lines
-    if ( !isSelected() && (
-             getPen().getLineType()==RS2::SolidLine ||
+    if ( !entity->isSelected() && (
+             entity->getPen().getLineType()==RS2::SolidLine ||
              view->getDrawingMode()==RS2::ModePreview)) {
-        painter->drawArc(cp,
-                         ra,
-                         getAngle1(), getAngle2(),
-                         isReversed());
+        painter->drawArc(cp, ra, a1, a2, false);
         return;
     }
 //    double styleFactor = getStyleFactor(view);
@@ -978,17 +983,15 @@ void RS_Arc::drawVisible(RS_Painter* painter, RS_GraphicView* view,
 
     // Pattern:
     const RS_LineTypePattern* pat;
-    if (isSelected()) {
+    if (entity->isSelected()) {
         pat = &RS_LineTypePattern::patternSelected;
     } else {
-        pat = view->getPattern(getPen().getLineType());
+        pat = view->getPattern(entity->getPen().getLineType());
     }
 
 	if (!pat || ra<0.5) {//avoid division by zero from small ra
 		RS_DEBUG->print("%s: Invalid line pattern or radius too small, drawing arc using solid line", __func__);
-        painter->drawArc(cp, ra,
-                         getAngle1(),getAngle2(),
-                         isReversed());
+        painter->drawArc(cp, ra, a1, a2, false);
         return;
     }
 
@@ -1005,54 +1008,29 @@ void RS_Arc::drawVisible(RS_Painter* painter, RS_GraphicView* view,
 
 
 
-    // create scaled pattern:
-	std::vector<double> da(0);
-    double patternSegmentLength(pat->totalLength);
-    double ira=1./ra;
-	size_t i(0);          // index counter
-    if(pat->num>0) {
-        double dpmm=static_cast<RS_PainterQt*>(painter)->getDpmm();
-        da.resize(pat->num);
-        while(i<pat->num){
-            //        da[j] = pat->pattern[i++] * styleFactor;
-            //fixme, stylefactor needed
-            da[i] =dpmm*(isReversed()? -fabs(pat->pattern[i]):fabs(pat->pattern[i]));
-            if( fabs(da[i]) < 1. ) da[i] = (da[i]>=0.)?1.:-1.;
-            da[i] *= ira;
-            i++;
-        }
-    }else {
-        //invalid pattern
-
-        RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Arc::draw(): invalid line pattern\n");
-        painter->drawArc(cp,
-                         ra,
-                         getAngle1(), getAngle2(),
-                         isReversed());
+    // pattern in pixels, shared by all arcs of the view:
+    RS_DashPattern const& dashPattern = view->getDashPattern(pat, painter);
+    std::vector<double> const& ds = dashPattern.dashes;
+    double const patternSegmentLength = dashPattern.length;
+    if (ds.empty()) {
+        painter->drawArc(cp, ra, a1, a2, false);
         return;
     }
+    double ira=1./ra;
 
     //    bool done = false;
     double total=remainder(patternOffset-0.5*patternSegmentLength,patternSegmentLength)-0.5*patternSegmentLength;
 
-    double a1(RS_Math::correctAngle(getAngle1()));
-    double a2(RS_Math::correctAngle(getAngle2()));
-
-    if(isReversed()) {//always draw from a1 to a2, so, patternOffset is is automatic
-        if(a1<a2+RS_TOLERANCE_ANGLE) a2 -= 2.*M_PI;
-        total = a1 - total*ira; //in angle
-    }else{
-        if(a2<a1+RS_TOLERANCE_ANGLE) a2 += 2.*M_PI;
-        total = a1 + total*ira; //in angle
-    }
+    // always drawn counter-clockwise from a1 to a2
+    total = a1 + total*ira; //in angle
     double limit(fabs(a1-a2));
     double t2;
     double a11,a21;
 
-    for(int j=0; fabs(total-a1)<limit ;j=(j+1)%i) {
-        t2=total+da[j];
+    for(size_t j=0; fabs(total-a1)<limit ;j=(j+1)%ds.size()) {
+        t2=total+fabs(ds[j])*ira;
 
-        if(pat->pattern[j]>0.0) {
+        if(ds[j]>0.0) {
 
             if (fabs(t2-a2)<limit) {
                 a11=(fabs(total-a2)<limit)?total:a1;
@@ -1060,7 +1038,7 @@ void RS_Arc::drawVisible(RS_Painter* painter, RS_GraphicView* view,
                 painter->drawArc(cp, ra,
                                  a11,
                                  a21,
-                                 isReversed());
+                                 false);
             }
         }
         total=t2;
@@ -232,6 +232,15 @@ public:
     virtual void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset);
     /** directly draw the arc, assuming the whole arc is within visible window */
     virtual void drawVisible(RS_Painter* painter, RS_GraphicView* view, double& patternOffset);
+    /**
+     * draws the visible parts of an arc of a circle counter-clockwise from
+     * baseAngle, with the pen and selection state of entity. Used for
+     * arcs and circles without creating temporary entities.
+     */
+    static void drawClipped(const RS_Entity* entity, RS_Painter* painter,
+                            RS_GraphicView* view, const RS_Vector& center,
+                            double radius, double baseAngle, double angleLength,
+                            double& patternOffset);
 
     friend std::ostream& operator << (std::ostream& os, const RS_Arc& a);
 
@@ -256,6 +265,11 @@ m0 x + m1 y + m2 =0
     virtual double areaLineIntegral() const;
 
 protected:
+    static void drawSpan(const RS_Entity* entity, RS_Painter* painter,
+                         RS_GraphicView* view, const RS_Vector& center,
+                         double radius, double a1, double a2,
+                         double& patternOffset);
+
     RS_ArcData data;
 
     /**
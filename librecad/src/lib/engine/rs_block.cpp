@@ -25,10 +25,15 @@
 **********************************************************************/
 
 
+#include <atomic>
 #include "rs_block.h"
 
 #include "rs_graphic.h"
 
+namespace {
+std::atomic<unsigned> renameCount{0};
+}
+
 RS_BlockData::RS_BlockData(const QString& _name,
 						   const RS_Vector& _basePoint,
 						   bool _frozen):
@@ -65,6 +70,19 @@ RS_Entity* RS_Block::clone() const {
 
 
 
+void RS_Block::setName(const QString& n) {
+    data.name = n;
+    ++renameCount;
+}
+
+
+
+unsigned RS_Block::getRenameCount() {
+    return renameCount;
+}
+
+
+
 RS_LayerList* RS_Block::getLayerList() {
     RS_Graphic* g = getGraphic();
     if (g) {
@@ -55,6 +55,8 @@ RS_BlockList::RS_BlockList(bool owner) {
  */
 void RS_BlockList::clear() {
     blocks.clear();
+    blockNames.clear();
+    nestedLists.clear();
 	activeBlock = nullptr;
 	setModified(true);
 }
@@ -100,6 +102,11 @@ bool RS_BlockList::add(RS_Block* block, bool notify) {
     RS_Block* b = find(block->getName());
 	if (!b) {
         blocks.append(block);
+        blockNames.insert(nameKey(block->getName()), block);
+        RS_BlockList* list = block->getBlockList();
+        if (list && list!=this) {
+            ++nestedLists[list];
+        }
 
         if (notify) {
             addNotification();
@@ -146,6 +153,13 @@ void RS_BlockList::remove(RS_Block* block) {
 #else
     blocks.removeOne(block);
 #endif
+    if (blockNames.value(nameKey(block->getName()))==block) {
+        blockNames.remove(nameKey(block->getName()));
+    }
+    RS_BlockList* list = block->getBlockList();
+    if (nestedLists.contains(list) && --nestedLists[list]<=0) {
+        nestedLists.remove(list);
+    }
 	for(auto l: blockListListeners){
 		l->blockRemoved(block);
 	}
@@ -178,7 +192,13 @@ void RS_BlockList::remove(RS_Block* block) {
 bool RS_BlockList::rename(RS_Block* block, const QString& name) {
 	if (block) {
 		if (!find(name)) {
+			if (blockNames.value(nameKey(block->getName()))==block) {
+				blockNames.remove(nameKey(block->getName()));
+			}
 			block->setName(name);
+			if (blocks.contains(block)) {
+				blockNames.insert(nameKey(name), block);
+			}
 			setModified(true);
 			return true;
 		}
@@ -211,28 +231,56 @@ void RS_BlockList::editBlock(RS_Block* block, const RS_Block& source) {
  */
 RS_Block* RS_BlockList::find(const QString& name) {
     //RS_DEBUG->print("RS_BlockList::find");
-	// Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-	std::vector<RS_BlockList const*> nodes;
-	std::set<RS_BlockList const*> searched;
-	searched.insert(nullptr);
-	nodes.push_back(this);
-	while (nodes.size()) {
-		auto const& list = nodes.back();
-		nodes.pop_back();
-		for (RS_Block* b: *list) {
-			if (b->getName() == name)
-				return b;
-			auto node = b->getBlockList();
-			if (!searched.count(node)) {
-				searched.insert(list);
-				nodes.push_back(b->getBlockList());
-			}
+	if (nestedLists.isEmpty()) {
+		RS_Block* b = blockNames.value(nameKey(name), nullptr);
+		if (b ? b->getName() != name : indexedRenames != RS_Block::getRenameCount()) {
+			// a block was renamed without rename(): it is still indexed
+			// by its old name
+			rebuildNameIndex();
+			b = blockNames.value(nameKey(name), nullptr);
 		}
+		return b;
 	}
+	std::set<RS_BlockList const*> searched;
+	return find(name, searched);
+}
 
+/**
+ * Looks up a block by name in this list, then in the block lists of
+ * blocks from other graphics. Lists in \p searched are skipped.
+ */
+RS_Block* RS_BlockList::find(const QString& name,
+							 std::set<RS_BlockList const*>& searched) {
+	if (!searched.insert(this).second)
+		return nullptr;
+	RS_Block* b = blockNames.value(nameKey(name), nullptr);
+	if (b ? b->getName() != name : indexedRenames != RS_Block::getRenameCount()) {
+		rebuildNameIndex();
+		b = blockNames.value(nameKey(name), nullptr);
+	}
+	if (b)
+		return b;
+	for (RS_BlockList* list: nestedLists.keys()) {
+		b = list->find(name, searched);
+		if (b)
+			return b;
+	}
 	return nullptr;
 }
 
+/**
+ * Rebuilds the name index from the blocks in the list.
+ */
+void RS_BlockList::rebuildNameIndex() {
+	indexedRenames = RS_Block::getRenameCount();
+	blockNames.clear();
+	blockNames.reserve(blocks.size());
+	for (RS_Block* b: blocks) {
+		if (!blockNames.contains(nameKey(b->getName())))
+			blockNames.insert(nameKey(b->getName()), b);
+	}
+}
+
 /**
  * Finds a new unique block name.
  *
@@ -29,7 +29,9 @@
 #define RS_BLOCKLIST_H
 
 
+#include <set>
 #include <QList>
+#include <QHash>
 
 class QString;
 class RS_Block;
@@ -99,10 +101,26 @@ public:
     friend std::ostream& operator << (std::ostream& os, RS_BlockList& b);
 
 private:
+    /**
+     * @return key of a block name in the name index. Block names are
+     * compared case sensitive.
+     */
+    static QString nameKey(const QString& name) {
+        return name;
+    }
+    void rebuildNameIndex();
+    RS_Block* find(const QString& name, std::set<RS_BlockList const*>& searched);
+
     //! Is the list owning the blocks?
     bool owner;
     //! Blocks in the graphic
     QList<RS_Block*> blocks;
+    //! blocks by name, kept in sync by add(), remove(), rename() and clear()
+    QHash<QString, RS_Block*> blockNames;
+    //! RS_Block::getRenameCount() when blockNames was built
+    unsigned indexedRenames = 0;
+    //! block lists of blocks belonging to another graphic, with a block count
+    QHash<RS_BlockList*, int> nestedLists;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> blockListListeners;
     //! Currently active block
@@ -771,10 +771,9 @@ bool RS_Circle::isVisibleInWindow(RS_GraphicView* view) const
 
 /** draw circle as a 2 pi arc */
 void RS_Circle::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) {
-    RS_Arc arc(getParent(), RS_ArcData(getCenter(),getRadius(),0.,2.*M_PI, false));
-    arc.setSelected(isSelected());
-    arc.setPen(getPen());
-    arc.draw(painter,view,patternOffset);
+	if (!(painter && view)) return;
+	RS_Arc::drawClipped(this, painter, view, getCenter(), getRadius(),
+						0., 2.*M_PI, patternOffset);
 }
 
 
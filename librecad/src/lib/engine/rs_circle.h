@@ -80,6 +80,10 @@ public:
 	const RS_CircleData& getData() const {
         return data;
     }
+    /** Sets new circle parameters. **/
+    void setData(const RS_CircleData& d) {
+        data = d;
+    }
 
 	virtual RS_VectorSolutions getRefPoints() const;
 
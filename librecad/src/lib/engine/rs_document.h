@@ -75,6 +75,20 @@ public:
         }
     }
 
+    /**
+     * Removes entities from the entity container in a single pass.
+     * Implementation from RS_Undo.
+     */
+    virtual void removeUndoables(const std::set<RS_Undoable*>& undoables) {
+        std::unordered_set<RS_Entity*> toRemove;
+        for (RS_Undoable* u: undoables) {
+            if (u && u->undoRtti()==RS2::UndoableEntity) {
+                toRemove.insert((RS_Entity*)u);
+            }
+        }
+        removeEntities(toRemove);
+    }
+
     /**
      * @return Currently active drawing pen.
      */
@@ -135,6 +149,24 @@ public:
 		RS_Undo::startUndoCycle();
 	}
 
+	/**
+	 * Overwritten to refresh the borders invalidated by the undo cycle.
+	 */
+	virtual void endUndoCycle() {
+		RS_Undo::endUndoCycle();
+		refreshBorders();
+	}
+	virtual bool undo() {
+		bool const ret = RS_Undo::undo();
+		refreshBorders();
+		return ret;
+	}
+	virtual bool redo() {
+		bool const ret = RS_Undo::redo();
+		refreshBorders();
+		return ret;
+	}
+
     void setGraphicView(RS_GraphicView * g) {gv = g;}
     RS_GraphicView* getGraphicView() {return gv;}
 
@@ -36,7 +36,7 @@
 #include "rs_linetypepattern.h"
 #include "rs_math.h"
 #include  "lc_quadratic.h"
-#include "rs_painterqt.h"
+#include "lc_rect.h"
 
 #ifdef EMU_C99
 #include "emu_c99.h" /* C99 math */
@@ -91,6 +91,25 @@ private:
 	double ra;
 	double k2;
 };
+
+/**
+ * @return length of the ellipse with radii ra and rb from parameter a1
+ * to a2, by Simpson's rule
+ */
+double spanLength(double ra, double rb, double a1, double a2)
+{
+	// finer steps around the vertices of flat ellipses
+	int n = static_cast<int>(std::min(1024., 8.*(a2 - a1)*std::max(ra/rb, 4.)));
+	n += n%2;
+	double const h = (a2 - a1)/n;
+	auto speed = [ra, rb](double a) {
+		return std::hypot(ra*sin(a), rb*cos(a));
+	};
+	double sum = speed(a1) + speed(a2);
+	for (int i = 1; i < n; ++i)
+		sum += (i%2 ? 4. : 2.)*speed(a1 + i*h);
+	return sum*h/3.;
+}
 }
 
 std::ostream& operator << (std::ostream& os, const RS_EllipseData& ed) {
@@ -1327,6 +1346,11 @@ const RS_EllipseData& RS_Ellipse::getData() const
 	return data;
 }
 
+void RS_Ellipse::setData(const RS_EllipseData& d)
+{
+	data = d;
+}
+
 
 
 /* Dongxu Li's Version, 19 Aug 2011
@@ -1704,73 +1728,33 @@ double RS_Ellipse::getMinorRadius() const {
 }
 
 void RS_Ellipse::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset) {
-	if(isEllipticArc()==false){
-        RS_Ellipse arc(*this);
-        arc.setAngle2(2.*M_PI);
-        arc.setReversed(false);
-        arc.draw(painter,view,patternOffset);
-        return;
-    }
-    //only draw the visible portion of line
-    RS_Vector vpMin(view->toGraph(0,view->getHeight()));
-    RS_Vector vpMax(view->toGraph(view->getWidth(),0));
-    QPolygonF visualBox(QRectF(vpMin.x,vpMin.y,vpMax.x-vpMin.x, vpMax.y-vpMin.y));
-
-    RS_Vector vpStart(isReversed()?getEndpoint():getStartpoint());
-    RS_Vector vpEnd(isReversed()?getStartpoint():getEndpoint());
-
-	std::vector<RS_Vector> vertex(0);
-    for(unsigned short i=0;i<4;i++){
-        const QPointF& vp(visualBox.at(i));
-		vertex.emplace_back(vp.x(),vp.y());
-    }
-    /** angles at cross points */
-	std::vector<double> crossPoints(0);
-
-    double baseAngle=isReversed()?getAngle2():getAngle1();
-    for(unsigned short i=0;i<4;i++){
-		RS_Line line{vertex.at(i),vertex.at((i+1)%4)};
-		auto vpIts=RS_Information::getIntersection(
-                    static_cast<RS_Entity*>(this), &line, true);
-//    std::cout<<"vpIts.size()="<<vpIts.size()<<std::endl;
-        if( vpIts.size()==0) continue;
-		for(const RS_Vector& vp: vpIts){
-			auto ap1=getTangentDirection(vp).angle();
-			auto ap2=line.getTangentDirection(vp).angle();
-            //ignore tangent points, because the arc doesn't cross over
-            if( fabs( remainder(ap2 - ap1, M_PI) ) < RS_TOLERANCE_ANGLE) continue;
-            crossPoints.push_back(
-                        RS_Math::getAngleDifference(baseAngle, getEllipseAngle(vp))
-                        );
-        }
-    }
-    if(vpStart.isInWindowOrdered(vpMin, vpMax)) crossPoints.push_back(0.);
-    if(vpEnd.isInWindowOrdered(vpMin, vpMax)) crossPoints.push_back(
-                RS_Math::getAngleDifference(baseAngle,isReversed()?getAngle1():getAngle2())
-                );
-
+	if (!( painter && view)) return;
+	double const baseAngle = isEllipticArc()?
+				(isReversed()?getAngle2():getAngle1()) : 0.;
+	double const angleLength = isEllipticArc()? getAngleLength() : 2.*M_PI;
+
+	//only draw the visible portion of the ellipse
+	LC_Rect const viewportRect{view->toGraph(0, view->getHeight()),
+				view->toGraph(view->getWidth(), 0)};
+	// early accept and reject by the borders
+	if (minV.valid && maxV.valid && minV.x <= maxV.x && minV.y <= maxV.y) {
+		LC_Rect const box{minV, maxV};
+		if (!viewportRect.intersects(box)) return;
+		if (box.inArea(viewportRect)) {
+			drawSpan(painter, view, baseAngle, baseAngle, baseAngle + angleLength);
+			return;
+		}
+	}
 
-    //sorting
-    std::sort(crossPoints.begin(),crossPoints.end());
-    //draw visible
-//    DEBUG_HEADER
-//    std::cout<<"crossPoints.size()="<<crossPoints.size()<<std::endl;
-    RS_Ellipse arc(*this);
-    arc.setSelected(isSelected());
-    arc.setPen(getPen());
-    arc.setReversed(false);
-    if( crossPoints.size() >= 2) {
-		for(size_t i=1;i<crossPoints.size();i+=2){
-			arc.setAngle1(baseAngle+crossPoints[i-1]);
-			arc.setAngle2(baseAngle+crossPoints[i]);
-            arc.drawVisible(painter,view,patternOffset);
-        }
-        return;
-    }
-    //a workaround for buggy equation solver, can be removed, when line-ellipse equation solver is reliable
-    if(isVisibleInWindow(view)){
-        arc.drawVisible(painter,view,patternOffset);
-    }
+	RS_Vector const& majorP = getMajorP();
+	RS_Vector const minorP = RS_Vector{-majorP.y, majorP.x}*getRatio();
+	LC_Rect::ArcSpans spans;
+	int const n = viewportRect.clipEllipticArc(getCenter(), majorP, minorP,
+											   baseAngle, angleLength, spans);
+	for (int i = 0; i < n; ++i) {
+		drawSpan(painter, view, baseAngle, baseAngle + spans[i].first,
+				 baseAngle + spans[i].second);
+	}
 }
 
 /** directly draw the arc, assuming the whole arc is within visible window */
@@ -1781,6 +1765,20 @@ void RS_Ellipse::drawVisible(RS_Painter* painter, RS_GraphicView* view, double&
 
     //visible in grahic view
 	if(!isVisibleInWindow(view)) return;
+	if (isEllipticArc()) {
+		double const baseAngle = isReversed()?getAngle2():getAngle1();
+		drawSpan(painter, view, baseAngle, baseAngle, baseAngle + getAngleLength());
+	} else {
+		drawSpan(painter, view, 0., 0., 2.*M_PI);
+	}
+}
+
+/**
+ * Draws the ellipse counter-clockwise from parameter a1 to a2, the line
+ * pattern starts at parameter base.
+ */
+void RS_Ellipse::drawSpan(RS_Painter* painter, RS_GraphicView* view,
+						  double base, double a1, double a2) const {
     double ra(getMajorRadius()*view->getFactor().x);
     double rb(getRatio()*ra);
     if(rb<RS_TOLERANCE) {//ellipse too small
@@ -1795,8 +1793,8 @@ void RS_Ellipse::drawVisible(RS_Painter* painter, RS_GraphicView* view, double&
         painter->drawEllipse(cp,
                              ra, rb,
                              mAngle,
-                             getAngle1(), getAngle2(),
-                             isReversed());
+                             a1, a2,
+                             false);
         return;
     }
 
@@ -1816,24 +1814,11 @@ void RS_Ellipse::drawVisible(RS_Painter* painter, RS_GraphicView* view, double&
     // Pen to draw pattern is always solid:
     RS_Pen pen = painter->getPen();
     pen.setLineType(RS2::SolidLine);
-    double a1(RS_Math::correctAngle(getAngle1()));
-    double a2(RS_Math::correctAngle(getAngle2()));
-    if (isReversed()) std::swap(a1,a2);
-    if(a2 <a1+RS_TOLERANCE_ANGLE) a2 +=2.*M_PI;
     painter->setPen(pen);
-	size_t i(0),j(0);
-	std::vector<double> ds(pat->num>0?pat->num:0);
-    if(pat->num>0){
-        double dpmm=static_cast<RS_PainterQt*>(painter)->getDpmm();
-        while( i<pat->num){
-            ds[i]= dpmm * pat->pattern[i] ;//pattern length
-            if(fabs(ds[i])<1.)
-                ds[i]=(ds[i]>=0.)?1.:-1.;
-			++i;
-        }
-        j=i;
-	}else {
-        RS_DEBUG->print(RS_Debug::D_WARNING,"Invalid pattern when drawing ellipse");
+    // pattern in pixels, shared by all ellipses of the view:
+    RS_DashPattern const& dashPattern = view->getDashPattern(pat, painter);
+    std::vector<double> const& ds = dashPattern.dashes;
+    if (ds.empty()) {
         painter->drawEllipse(cp,
                              ra, rb,
                              mAngle,
@@ -1843,13 +1828,24 @@ void RS_Ellipse::drawVisible(RS_Painter* painter, RS_GraphicView* view, double&
         return;
     }
 
+    // the pattern starts at base, not at the view border, so dashes
+    // match in views or tiles clipping the ellipse differently
+    size_t i(0);
+    double phase = (a1 > base)?
+                fmod(spanLength(ra, rb, base, a1), dashPattern.length) : 0.;
+    while (phase >= fabs(ds[i])) {
+        phase -= fabs(ds[i]);
+        i = (i+1)%ds.size();
+    }
+
     double curA(a1);
     bool notDone(true);
 
-    for(i=0;notDone;i=(i+1)%j) {//draw patterned ellipse
+    for(;notDone;i=(i+1)%ds.size()) {//draw patterned ellipse
 
-		double nextA = curA + fabs(ds[i])/
+		double nextA = curA + (fabs(ds[i]) - phase)/
                 RS_Vector(ra*sin(curA),rb*cos(curA)).magnitude();
+        phase = 0.;
         if(nextA>a2){
             nextA=a2;
             notDone=false;
@@ -127,6 +127,8 @@ public:
 
     /** @return Copy of data that defines the ellipse. **/
 	const RS_EllipseData& getData() const;
+    /** Sets new ellipse parameters. **/
+    void setData(const RS_EllipseData& d);
 
 	virtual RS_VectorSolutions getRefPoints() const;
 
@@ -259,6 +261,9 @@ public:
 	virtual double areaLineIntegral() const;
 
 protected:
+    void drawSpan(RS_Painter* painter, RS_GraphicView* view,
+                  double base, double a1, double a2) const;
+
     RS_EllipseData data;
 };
 
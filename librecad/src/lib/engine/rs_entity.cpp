@@ -26,6 +26,7 @@
 **********************************************************************/
 
 
+#include <atomic>
 #include <iostream>
 #include <utility>
 #include <QPolygon>
@@ -94,7 +95,8 @@ void RS_Entity::init() {
  * Gives this entity a new unique id.
  */
 void RS_Entity::initId() {
-    static unsigned long int idCounter=0;
+    // entities are created while drawing in worker threads
+    static std::atomic<unsigned long> idCounter{0};
     id = idCounter++;
 }
 
@@ -111,6 +113,35 @@ void RS_Entity::resetBorders() {
 }
 
 
+/**
+ * The parents are marked as well, as their borders depend on this one.
+ */
+void RS_Entity::invalidateBorders() {
+	for (RS_Entity* e = this; e; e = e->getParent()) {
+		e->bordersDirty = true;
+	}
+}
+
+
+void RS_Entity::updateBorders() {
+	calculateBorders();
+}
+
+
+void RS_Entity::refreshBorders() {
+	for (RS_Entity* e = this; e && e->bordersDirty; e = e->parent) {
+		RS_Vector const vMin = e->minV;
+		RS_Vector const vMax = e->maxV;
+		// cleared first, updateBorders() refreshes the children
+		e->bordersDirty = false;
+		e->updateBorders();
+		if (e->parent && (vMin != e->minV || vMax != e->maxV)) {
+			e->parent->updateSpatialIndex(e);
+		}
+	}
+}
+
+
 void RS_Entity::moveBorders(const RS_Vector& offset){
 	minV.move(offset);
 	maxV.move(offset);
@@ -216,6 +247,10 @@ bool RS_Entity::isProcessed() const {
 void RS_Entity::undoStateChanged(bool /*undone*/) {
         setSelected(false);
     update();
+    // the entity is hidden or shown again
+    if (parent) {
+        parent->invalidateBorders();
+    }
 }
 
 
@@ -298,7 +333,7 @@ bool RS_Entity::isVisibleInWindow(RS_GraphicView* view) const
 		RS_Line const line{vps.at(i),vps.at((i+1)%4)};
 		if( RS_Information::getIntersection(this, &line, true).size()>0) return true;
     }
-    if( minV.isInWindowOrdered(vpMin,vpMax)||maxV.isInWindowOrdered(vpMin,vpMax)) return true;
+    if( getMin().isInWindowOrdered(vpMin,vpMax)||getMax().isInWindowOrdered(vpMin,vpMax)) return true;
     return false;
 }
 
@@ -455,7 +490,7 @@ bool RS_Entity::isHighlighted() const{
 
 
 RS_Vector RS_Entity::getSize() const {
-	return maxV-minV;
+	return getMax()-getMin();
 }
 
 /**
@@ -738,9 +773,9 @@ RS_Layer* RS_Entity::getLayer(bool resolve) const {
 void RS_Entity::setLayer(const QString& name) {
     RS_Graphic* graphic = getGraphic();
     if (graphic) {
-        layer = graphic->findLayer(name);
+        setLayer(graphic->findLayer(name));
     } else {
-		layer = nullptr;
+		setLayer(nullptr);
     }
 }
 
@@ -750,7 +785,11 @@ void RS_Entity::setLayer(const QString& name) {
  * Sets the layer of this entity to the layer given.
  */
 void RS_Entity::setLayer(RS_Layer* l) {
+	RS_Layer* const previous = layer;
     layer = l;
+	if (parent && previous != l) {
+		parent->entityLayerChanged(this, previous);
+	}
 }
 
 
@@ -764,9 +803,9 @@ void RS_Entity::setLayerToActive() {
     RS_Graphic* graphic = getGraphic();
 
     if (graphic) {
-        layer = graphic->getActiveLayer();
+        setLayer(graphic->getActiveLayer());
     } else {
-		layer = nullptr;
+		setLayer(nullptr);
     }
 }
 
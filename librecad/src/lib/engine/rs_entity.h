@@ -220,23 +220,40 @@ public:
     }
 
     /**
-     * This method doesn't do any calculations.
-     * @return minimum coordinate of the entity.
+     * @return minimum coordinate of the entity. Invalidated borders are
+     * only up to date after refreshBorders().
      * @see calculateBorders()
+     * @see invalidateBorders()
      */
     RS_Vector getMin() const {
         return minV;
     }
 
     /**
-     * This method doesn't do any calculations.
-     * @return minimum coordinate of the entity.
+     * @return maximum coordinate of the entity. Invalidated borders are
+     * only up to date after refreshBorders().
      * @see calculateBorders()
+     * @see invalidateBorders()
      */
     RS_Vector getMax() const {
         return maxV;
     }
 
+    /**
+     * Marks the borders of this entity and of all its parents as out of
+     * date, so that several changes only recalculate them once.
+     * @see refreshBorders()
+     */
+    void invalidateBorders();
+
+    /**
+     * Recalculates the invalidated borders of this entity and of its
+     * parents and updates their boxes in the spatial index. Called on the
+     * GUI thread where a change is completed, e.g. by
+     * RS_Document::endUndoCycle(), before the borders are read again.
+     */
+    void refreshBorders();
+
     /**
      * This method returns the difference of max and min returned
      * by the above functions.
@@ -506,6 +523,12 @@ public:
      */
     virtual void draw(RS_Painter* painter, RS_GraphicView* view,
                       double& patternOffset ) = 0;
+    /**
+     * Computes what draw() would otherwise compute on demand, so that
+     * drawing in view only reads the entity and can run in several
+     * threads as long as the entity is not modified.
+     */
+    virtual void prepareDrawing(RS_GraphicView* /*view*/) {}
 
     double getStyleFactor(RS_GraphicView* view);
 
@@ -518,6 +541,11 @@ public:
 
     /** Recalculates the borders of this entity. */
     virtual void calculateBorders() = 0;
+    /**
+     * Recalculates invalidated borders. The default implementation
+     * calls calculateBorders().
+     */
+    virtual void updateBorders();
     /** whether the entity is on a constructionLayer */
     //! constructionLayer contains entities of infinite length, constructionLayer doesn't show up in print
     bool isConstruction(bool typeCheck = false) const; // ignore certain entity types for constructionLayer check
@@ -567,7 +595,7 @@ protected:
     RS_Vector maxV;
 
     //! Pointer to layer
-    RS_Layer* layer;
+    RS_Layer* layer = nullptr;
 
     //! Entity id
     unsigned long int id;
@@ -578,6 +606,9 @@ protected:
     //! auto updating enabled?
     bool updateEnabled;
 
+    //! borders have to be recalculated, see invalidateBorders()
+    bool bordersDirty = false;
+
 private:
 	std::map<QString, QString> varList;
 };
@@ -26,6 +26,7 @@
 
 
 #include <QObject>
+#include <algorithm>
 #include <cmath>
 
 #include "rs_dialogfactory.h"
@@ -50,6 +51,11 @@
 
 bool RS_EntityContainer::autoUpdateBorders = true;
 
+namespace {
+//! containers with fewer entities are searched linearly
+const int minSpatialIndexSize = 256;
+}
+
 /**
  * Default constructor.
  *
@@ -127,6 +133,8 @@ void RS_EntityContainer::detach() {
 
     // clear shared pointers:
     entities.clear();
+    spatialIndex.clear();
+    positions.clear();
     setOwner(autoDel);
 
     // point to new deep copies:
@@ -327,11 +335,16 @@ void RS_EntityContainer::addEntity(RS_Entity* entity) {
     if (entity->rtti()==RS2::EntityImage ||
             entity->rtti()==RS2::EntityHatch) {
         entities.prepend(entity);
+        positions.clear();
     } else {
         entities.append(entity);
+        updatePositions(entities.size() - 1);
+    }
+    if (spatialIndex.isValid()) {
+        spatialIndex.insert(entity);
     }
     if (autoUpdateBorders) {
-        adjustBorders(entity);
+        extendBorders(entity);
     }
 }
 
@@ -344,8 +357,11 @@ void RS_EntityContainer::appendEntity(RS_Entity* entity){
 	if (!entity)
         return;
     entities.append(entity);
+    updatePositions(entities.size() - 1);
+    if (spatialIndex.isValid())
+        spatialIndex.insert(entity);
     if (autoUpdateBorders)
-        adjustBorders(entity);
+        extendBorders(entity);
 }
 
 /**
@@ -355,8 +371,11 @@ void RS_EntityContainer::appendEntity(RS_Entity* entity){
 void RS_EntityContainer::prependEntity(RS_Entity* entity){
 	if (!entity) return;
     entities.prepend(entity);
+    positions.clear();
+    if (spatialIndex.isValid())
+        spatialIndex.insert(entity);
     if (autoUpdateBorders)
-        adjustBorders(entity);
+        extendBorders(entity);
 }
 
 /**
@@ -365,6 +384,7 @@ void RS_EntityContainer::prependEntity(RS_Entity* entity){
  */
 void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *>& entList){
     if (entList.isEmpty()) return;
+    positions.clear();
     int ci = 0; //current index for insert without invert order
     bool ret, into = false;
 	RS_Entity *mid = nullptr;
@@ -402,9 +422,13 @@ void RS_EntityContainer::insertEntity(int index, RS_Entity* entity) {
 	if (!entity) return;
 
     entities.insert(index, entity);
+    positions.clear();
 
+    if (spatialIndex.isValid()) {
+        spatialIndex.insert(entity);
+    }
     if (autoUpdateBorders) {
-        adjustBorders(entity);
+        extendBorders(entity);
     }
 }
 
@@ -439,24 +463,109 @@ bool RS_EntityContainer::removeEntity(RS_Entity* entity) {
 	//RLZ TODO: in Q3PtrList if 'entity' is nullptr remove the current item-> at.(entIdx)
     //    and sets 'entIdx' in next() or last() if 'entity' is the last item in the list.
 	//    in LibreCAD is never called with nullptr
-    bool ret;
-#if QT_VERSION < 0x040400
-    ret = emu_qt44_removeOne(entities, entity);
-#else
-    ret = entities.removeOne(entity);
-#endif
-
+	// the position cache is only used if it exists already, building it
+	// costs more than a linear search
+	int const index = positions.empty() ?
+				entities.indexOf(entity) : entityPosition(entity);
+	bool const ret = index >= 0;
+
+	bool shrink = false;
+    if (ret) {
+        shrink = autoUpdateBorders && isOnBorders(entity);
+        entities.removeAt(index);
+        positions.erase(entity);
+        // the following entities move up by one
+        updatePositions(index);
+        if (spatialIndex.isValid())
+            spatialIndex.remove(entity);
+    }
     if (autoDelete && ret) {
         delete entity;
     }
-    if (autoUpdateBorders) {
-        calculateBorders();
+    if (shrink) {
+        invalidateBorders();
+        refreshBorders();
     }
     return ret;
 }
 
 
 
+unsigned RS_EntityContainer::removeEntities(const std::unordered_set<RS_Entity*>& toRemove) {
+	if (toRemove.empty()) {
+		return 0;
+	}
+
+	auto const first = std::find_if(entities.begin(), entities.end(),
+									[&toRemove](RS_Entity* e) {
+		return toRemove.count(e) > 0;
+	});
+	int const from = first - entities.begin();
+	std::vector<RS_Entity*> removed;
+	entities.erase(std::remove_if(first, entities.end(),
+								  [&](RS_Entity* e) {
+		if (!toRemove.count(e))
+			return false;
+		removed.push_back(e);
+		return true;
+	}), entities.end());
+
+	if (removed.empty()) {
+		return 0;
+	}
+	for (RS_Entity* e: removed)
+		positions.erase(e);
+	updatePositions(from);
+
+	if (spatialIndex.isValid()) {
+		// rebuilding is cheaper than removing a large part of the tree
+		if (4 * removed.size() > static_cast<size_t>(entities.size())) {
+			invalidateSpatialIndex();
+		} else {
+			for (RS_Entity* e: removed)
+				spatialIndex.remove(e);
+		}
+	}
+
+	bool shrink = false;
+	for (RS_Entity* e: removed) {
+		if (autoUpdateBorders && !shrink) {
+			shrink = isOnBorders(e);
+		}
+		if (autoDelete) {
+			delete e;
+		}
+	}
+	if (shrink) {
+		invalidateBorders();
+		refreshBorders();
+	}
+	return removed.size();
+}
+
+
+
+/**
+ * @return false, if the entity lies inside the borders of this container,
+ * so that removing it does not change the borders
+ */
+bool RS_EntityContainer::isOnBorders(const RS_Entity* entity) const {
+	if (entities.isEmpty()) {
+		return true;
+	}
+	RS_Layer* layer = entity->getLayer();
+	if (!entity->isVisible() || (layer && layer->isFrozen())
+			|| (entity->isContainer() && entity->count() == 0)) {
+		return false;
+	}
+	RS_Vector const& vMin = entity->getMin();
+	RS_Vector const& vMax = entity->getMax();
+	return vMin.x <= minV.x + RS_TOLERANCE || vMin.y <= minV.y + RS_TOLERANCE
+			|| vMax.x >= maxV.x - RS_TOLERANCE || vMax.y >= maxV.y - RS_TOLERANCE;
+}
+
+
+
 /**
  * Erases all entities in this container and resets the borders..
  */
@@ -466,6 +575,8 @@ void RS_EntityContainer::clear() {
             delete entities.takeFirst();
     } else
         entities.clear();
+    spatialIndex.clear();
+    positions.clear();
     resetBorders();
 }
 
@@ -555,6 +666,7 @@ void RS_EntityContainer::adjustBorders(RS_Entity* entity) {
 void RS_EntityContainer::calculateBorders() {
     RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
+    bordersDirty = false;
 	resetBorders();
 	for (RS_Entity* e: entities){
 
@@ -564,7 +676,15 @@ void RS_EntityContainer::calculateBorders() {
         //                        "isVisible: %d", (int)e->isVisible());
 
 		if (e->isVisible() && !(layer && layer->isFrozen())) {
-            e->calculateBorders();
+            if (spatialIndex.isValid()) {
+                RS_Vector const vMin = e->getMin();
+                RS_Vector const vMax = e->getMax();
+                e->calculateBorders();
+                if (vMin != e->getMin() || vMax != e->getMax())
+                    spatialIndex.update(e);
+            } else {
+                e->calculateBorders();
+            }
             adjustBorders(e);
         }
     }
@@ -572,7 +692,42 @@ void RS_EntityContainer::calculateBorders() {
     RS_DEBUG->print("RS_EntityContainer::calculateBorders: size 1: %f,%f",
                     getSize().x, getSize().y);
 
-    // needed for correcting corrupt data (PLANS.dxf)
+    correctBorders();
+
+    RS_DEBUG->print("RS_EntityCotnainer::calculateBorders: size: %f,%f",
+                    getSize().x, getSize().y);
+
+    //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
+
+    //printf("borders: %lf/%lf  %lf/%lf\n", minV.x, minV.y, maxV.x, maxV.y);
+    //RS_Entity::calculateBorders();
+}
+
+
+
+/**
+ * Recalculates invalidated borders from the borders of the entities.
+ * Unlike calculateBorders(), the entities only recalculate their own
+ * borders if they were invalidated as well, see refreshBorders().
+ */
+void RS_EntityContainer::updateBorders() {
+	resetBorders();
+	for (RS_Entity* e: entities){
+        e->refreshBorders();
+        RS_Layer* layer = e->getLayer();
+		if (e->isVisible() && !(layer && layer->isFrozen())) {
+            adjustBorders(e);
+        }
+    }
+    correctBorders();
+}
+
+
+
+/**
+ * Needed for correcting corrupt data (PLANS.dxf)
+ */
+void RS_EntityContainer::correctBorders() {
     if (minV.x>maxV.x || minV.x>RS_MAXDOUBLE || maxV.x>RS_MAXDOUBLE
             || minV.x<RS_MINDOUBLE || maxV.x<RS_MINDOUBLE) {
 
@@ -585,14 +740,6 @@ void RS_EntityContainer::calculateBorders() {
         minV.y = 0.0;
         maxV.y = 0.0;
     }
-
-    RS_DEBUG->print("RS_EntityCotnainer::calculateBorders: size: %f,%f",
-                    getSize().x, getSize().y);
-
-    //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
-
-    //printf("borders: %lf/%lf  %lf/%lf\n", minV.x, minV.y, maxV.x, maxV.y);
-    //RS_Entity::calculateBorders();
 }
 
 
@@ -604,32 +751,27 @@ void RS_EntityContainer::calculateBorders() {
 void RS_EntityContainer::forcedCalculateBorders() {
     //RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
+    bordersDirty = false;
 	resetBorders();
 	for (RS_Entity* e: entities){
 
         //RS_Layer* layer = e->getLayer();
 
+        RS_Vector const vMin = e->getMin();
+        RS_Vector const vMax = e->getMax();
         if (e->isContainer()) {
             ((RS_EntityContainer*)e)->forcedCalculateBorders();
         } else {
             e->calculateBorders();
         }
+        if (spatialIndex.isValid()
+                && (vMin != e->getMin() || vMax != e->getMax())) {
+            spatialIndex.update(e);
+        }
         adjustBorders(e);
     }
 
-    // needed for correcting corrupt data (PLANS.dxf)
-    if (minV.x>maxV.x || minV.x>RS_MAXDOUBLE || maxV.x>RS_MAXDOUBLE
-            || minV.x<RS_MINDOUBLE || maxV.x<RS_MINDOUBLE) {
-
-        minV.x = 0.0;
-        maxV.x = 0.0;
-    }
-    if (minV.y>maxV.y || minV.y>RS_MAXDOUBLE || maxV.y>RS_MAXDOUBLE
-            || minV.y<RS_MINDOUBLE || maxV.y<RS_MINDOUBLE) {
-
-        minV.y = 0.0;
-        maxV.y = 0.0;
-    }
+    correctBorders();
 
     //RS_DEBUG->print("  borders: %f/%f %f/%f", minV.x, minV.y, maxV.x, maxV.y);
 
@@ -663,6 +805,7 @@ void RS_EntityContainer::updateDimensions(bool autoText) {
             ((RS_EntityContainer*)e)->updateDimensions(autoText);
         }
     }
+    invalidateSpatialIndex();
 
     RS_DEBUG->print("RS_EntityContainer::updateDimensions() OK");
 }
@@ -684,6 +827,7 @@ void RS_EntityContainer::updateInserts() {
             ((RS_EntityContainer*)e)->updateInserts();
         }
     }
+    invalidateSpatialIndex();
 
     RS_DEBUG->print("RS_EntityContainer::updateInserts() OK");
 }
@@ -732,6 +876,7 @@ void RS_EntityContainer::updateSplines() {
             ((RS_EntityContainer*)e)->updateSplines();
         }
     }
+    invalidateSpatialIndex();
 
     RS_DEBUG->print("RS_EntityContainer::updateSplines() OK");
 }
@@ -744,6 +889,7 @@ void RS_EntityContainer::update() {
 	for (RS_Entity* e: entities){
 		e->update();
     }
+    invalidateSpatialIndex();
 }
 
 void RS_EntityContainer::addRectangle(RS_Vector const& v0, RS_Vector const& v1)
@@ -1105,6 +1251,14 @@ RS_Entity* RS_EntityContainer::entityAt(int index) {
 }
 
 void RS_EntityContainer::setEntityAt(int index,RS_Entity* en){
+	if (spatialIndex.isValid()) {
+		spatialIndex.remove(entities.at(index));
+		spatialIndex.insert(en);
+	}
+	if (!positions.empty()) {
+		positions.erase(entities.at(index));
+		positions[en] = index;
+	}
 	if(autoDelete && entities.at(index)) {
 		delete entities.at(index);
 	}
@@ -1124,7 +1278,7 @@ int RS_EntityContainer::entityAt() {
  * Finds the given entity and makes it the current entity if found.
  */
 int RS_EntityContainer::findEntity(RS_Entity const* const entity) {
-	entIdx = entities.indexOf(const_cast<RS_Entity*>(entity));
+	entIdx = entityPosition(entity);
     return entIdx;
 }
 
@@ -1140,8 +1294,7 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-	for (RS_Entity* en: entities){
-
+	auto nearestEndpoint = [&](RS_Entity* en) {
 		if (en->isVisible()
 				&& !en->getParent()->ignoredOnModification()
 				){//no end point for Insert, text, Dim
@@ -1154,7 +1307,20 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                 }
             }
         }
-    }
+	};
+
+	if (useSpatialIndex()) {
+		//endpoints are within the bounding box
+		spatialIndex.visitNearest(coord, [&](RS_Entity* en, double boxDist) {
+			if (boxDist > minDist) return false;
+			nearestEndpoint(en);
+			return true;
+		});
+	} else {
+		for (RS_Entity* en: entities){
+			nearestEndpoint(en);
+		}
+	}
 
     return closestPoint;
 }
@@ -1173,15 +1339,8 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    //QListIterator<RS_Entity> it = createIterator();
-    //RS_Entity* en;
-	//while ( (en = it.current())  ) {
-    //    ++it;
-
-    unsigned i0=0;
-	for(auto en: entities){
+	auto nearestEndpoint = [&](RS_Entity* en) {
 		if (!en->getParent()->ignoredOnModification() ){//no end point for Insert, text, Dim
-//            std::cout<<"find nearest for entity "<<i0<<std::endl;
             point = en->getNearestEndpoint(coord, &curDist);
             if (point.valid && curDist<minDist) {
                 closestPoint = point;
@@ -1194,8 +1353,19 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector& coord,
                 }
             }
         }
-        i0++;
-    }
+	};
+
+	if (useSpatialIndex()) {
+		spatialIndex.visitNearest(coord, [&](RS_Entity* en, double boxDist) {
+			if (boxDist > minDist) return false;
+			nearestEndpoint(en);
+			return true;
+		});
+	} else {
+		for(auto en: entities){
+			nearestEndpoint(en);
+		}
+	}
 
 //    std::cout<<__FILE__<<" : "<<__func__<<" : line "<<__LINE__<<std::endl;
 //    std::cout<<"count()="<<const_cast<RS_EntityContainer*>(this)->count()<<"\tminDist= "<<minDist<<"\tclosestPoint="<<closestPoint;
@@ -1412,13 +1582,12 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
 	RS_Entity* closestEntity = nullptr;    // closest entity found
 	RS_Entity* subEntity = nullptr;
 
-	for(auto e: entities){
-
+	auto distanceToPoint = [&](RS_Entity* e) {
         if (e->isVisible()) {
             RS_DEBUG->print("entity: getDistanceToPoint");
             RS_DEBUG->print("entity: %d", e->rtti());
             // bug#426, need to ignore Images to find nearest intersections
-            if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage) continue;
+            if(level==RS2::ResolveAllButTextImage && e->rtti()==RS2::EntityImage) return;
             curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
 
             RS_DEBUG->print("entity: getDistanceToPoint: OK");
@@ -1435,7 +1604,21 @@ double RS_EntityContainer::getDistanceToPoint(const RS_Vector& coord,
                 minDist = curDist;
             }
         }
-    }
+	};
+
+	if (useSpatialIndex()) {
+		//the distance to an entity is never smaller than the distance to
+		//its box in the index, stop once the boxes are farther away
+		spatialIndex.visitNearest(coord, [&](RS_Entity* e, double boxDist) {
+			if (boxDist > minDist) return false;
+			distanceToPoint(e);
+			return true;
+		});
+	} else {
+		for(auto e: entities){
+			distanceToPoint(e);
+		}
+	}
 
 	if (entity) {
         *entity = closestEntity;
@@ -1478,6 +1661,128 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,
 
 
 
+std::vector<RS_Entity*> RS_EntityContainer::entitiesInRect(const LC_Rect& area) const
+{
+	if (useSpatialIndex()) {
+		std::vector<RS_Entity*> ret = spatialIndex.queryRect(area);
+		std::sort(ret.begin(), ret.end(),
+				  [this](RS_Entity const* a, RS_Entity const* b) {
+			return entityPosition(a) < entityPosition(b);
+		});
+		return ret;
+	}
+
+	std::vector<RS_Entity*> ret;
+	for (RS_Entity* e: entities) {
+		if (!LC_SpatialIndex::isBounded(e)
+				|| area.intersects(LC_Rect{e->getMin(), e->getMax()}))
+			ret.push_back(e);
+	}
+	return ret;
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::nearestEntities(const RS_Vector& coord,
+															unsigned k) const
+{
+	if (useSpatialIndex())
+		return spatialIndex.queryNearest(coord, k);
+
+	std::vector<std::pair<double, RS_Entity*>> candidates;
+	candidates.reserve(entities.size());
+	for (RS_Entity* e: entities) {
+		double d = 0.;
+		if (LC_SpatialIndex::isBounded(e)) {
+			RS_Vector const vMin = e->getMin();
+			RS_Vector const vMax = e->getMax();
+			double const dx = std::max({vMin.x - coord.x, 0., coord.x - vMax.x});
+			double const dy = std::max({vMin.y - coord.y, 0., coord.y - vMax.y});
+			d = std::hypot(dx, dy);
+		}
+		candidates.emplace_back(d, e);
+	}
+	size_t const n = std::min<size_t>(k, candidates.size());
+	std::partial_sort(candidates.begin(), candidates.begin() + n, candidates.end(),
+					  [](std::pair<double, RS_Entity*> const& a,
+					  std::pair<double, RS_Entity*> const& b) {
+		return a.first < b.first;
+	});
+	std::vector<RS_Entity*> ret;
+	ret.reserve(n);
+	for (size_t i = 0; i < n; ++i)
+		ret.push_back(candidates[i].second);
+	return ret;
+}
+
+void RS_EntityContainer::updateSpatialIndex(RS_Entity* entity)
+{
+	if (spatialIndex.isValid())
+		spatialIndex.update(entity);
+}
+
+void RS_EntityContainer::childBordersGrown(RS_Entity* child)
+{
+	// only a box in the index can be stale. Entities not in the index
+	// are not children yet, e.g. polylines on import, or are read when
+	// the index is built.
+	if (!spatialIndex.isValid() || !spatialIndex.update(child))
+		return;
+	RS_Layer* layer = child->getLayer();
+	if (autoUpdateBorders && child->isVisible() && !(layer && layer->isFrozen()))
+		extendBorders(child);
+}
+
+/**
+ * Grows the borders of this container by those of entity. The parent
+ * is told if they changed, the box of this container in its spatial
+ * index and its borders have to grow too.
+ */
+void RS_EntityContainer::extendBorders(RS_Entity* entity)
+{
+	RS_Vector const vMin = minV;
+	RS_Vector const vMax = maxV;
+	adjustBorders(entity);
+	if (parent && (vMin != minV || vMax != maxV))
+		parent->childBordersGrown(this);
+}
+
+void RS_EntityContainer::invalidateSpatialIndex()
+{
+	spatialIndex.clear();
+}
+
+int RS_EntityContainer::entityPosition(const RS_Entity* entity) const
+{
+	if (positions.empty()) {
+		positions.reserve(entities.size());
+		for (int i = 0; i < entities.size(); ++i)
+			positions[entities.at(i)] = i;
+	}
+	auto it = positions.find(entity);
+	return it != positions.end() ? it->second : -1;
+}
+
+void RS_EntityContainer::updatePositions(int from)
+{
+	// keep a complete cache, otherwise it is built on the next lookup
+	if (positions.empty())
+		return;
+	for (int i = from; i < entities.size(); ++i)
+		positions[entities.at(i)] = i;
+}
+
+bool RS_EntityContainer::useSpatialIndex() const
+{
+	if (entities.size() < minSpatialIndexSize) {
+		if (spatialIndex.isValid())
+			spatialIndex.clear();
+		return false;
+	}
+	if (!spatialIndex.isValid()) {
+		spatialIndex.build(std::vector<RS_Entity*>(entities.begin(), entities.end()));
+	}
+	return true;
+}
+
 /**
  * Rearranges the atomic entities in this container in a way that connected
  * entities are stored in the right order and direction.
@@ -1622,6 +1927,7 @@ void RS_EntityContainer::move(const RS_Vector& offset) {
             e->moveBorders(offset);
         }
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders) {
         moveBorders(offset);
     }
@@ -1635,6 +1941,7 @@ void RS_EntityContainer::rotate(const RS_Vector& center, const double& angle) {
 	for(auto e: entities){
         e->rotate(center, angleVector);
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders) {
         calculateBorders();
     }
@@ -1646,6 +1953,7 @@ void RS_EntityContainer::rotate(const RS_Vector& center, const RS_Vector& angleV
 	for(auto e: entities){
         e->rotate(center, angleVector);
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders) {
         calculateBorders();
     }
@@ -1659,6 +1967,7 @@ void RS_EntityContainer::scale(const RS_Vector& center, const RS_Vector& factor)
             e->scale(center, factor);
         }
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders) {
         calculateBorders();
     }
@@ -1673,6 +1982,7 @@ void RS_EntityContainer::mirror(const RS_Vector& axisPoint1, const RS_Vector& ax
             e->mirror(axisPoint1, axisPoint2);
         }
     }
+    invalidateSpatialIndex();
 }
 
 
@@ -1689,6 +1999,7 @@ void RS_EntityContainer::stretch(const RS_Vector& firstCorner,
 		for(auto e: entities){
             e->stretch(firstCorner, secondCorner, offset);
         }
+        invalidateSpatialIndex();
     }
 
     // some entitiycontainers might need an update (e.g. RS_Leader):
@@ -1704,6 +2015,7 @@ void RS_EntityContainer::moveRef(const RS_Vector& ref,
 	for(auto e: entities){
         e->moveRef(ref, offset);
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders) {
         calculateBorders();
     }
@@ -1717,6 +2029,7 @@ void RS_EntityContainer::moveSelectedRef(const RS_Vector& ref,
 	for(auto e: entities){
         e->moveSelectedRef(ref, offset);
     }
+    invalidateSpatialIndex();
     if (autoUpdateBorders) {
         calculateBorders();
     }
@@ -1726,6 +2039,7 @@ void RS_EntityContainer::revertDirection() {
 	for(int k = 0; k < entities.size() / 2; ++k) {
 		entities.swap(k, entities.size() - 1 - k);
 	}
+	positions.clear();
 
 	for(RS_Entity*const entity: entities) {
 		entity->revertDirection();
@@ -1744,6 +2058,18 @@ void RS_EntityContainer::draw(RS_Painter* painter, RS_GraphicView* view,
         return;
     }
 
+	// large containers: only visit entities within the view, in list order.
+	// The boxes are current: prepareDrawing() refreshes them and children
+	// growing in place report it through childBordersGrown().
+	if (!view->isPrinting() && useSpatialIndex()) {
+		LC_Rect const viewRect = view->getViewRect(view->getCullingMargin());
+		std::vector<RS_Entity*> const visible = entitiesInRect(viewRect);
+		if (visible.size() < (size_t) entities.size()) {
+			for (RS_Entity* e: visible)
+				view->drawEntity(painter, e);
+			return;
+		}
+	}
 
 	for(auto e: entities){
 
@@ -1751,6 +2077,21 @@ void RS_EntityContainer::draw(RS_Painter* painter, RS_GraphicView* view,
     }
 }
 
+void RS_EntityContainer::prepareDrawing(RS_GraphicView* view)
+{
+	refreshBorders();
+	bool const indexed = useSpatialIndex();
+	if (indexed && !entities.isEmpty())
+		entityPosition(entities.first());
+	for (RS_Entity* e: entities) {
+		e->prepareDrawing(view);
+		// the boxes queried while drawing must contain the entities,
+		// also if their borders changed in place without an update
+		if (indexed)
+			spatialIndex.refresh(e);
+	}
+}
+
 /**
  * @brief areaLineIntegral, line integral for contour area calculation by Green's Theorem
  * Contour Area =\oint x dy
@@ -30,7 +30,10 @@
 
 #include <vector>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include "rs_entity.h"
+#include "lc_spatialindex.h"
 
 /**
  * Class representing a tree of entities.
@@ -76,6 +79,11 @@ public:
 	virtual double getLength() const;
 
     virtual void undoStateChanged(bool undone);
+    /**
+     * Called when the layer of a child entity has changed.
+     * @param previous the layer the entity was on before
+     */
+    virtual void entityLayerChanged(RS_Entity* /*entity*/, RS_Layer* /*previous*/) {}
     virtual void setVisible(bool v);
 
     virtual bool setSelected(bool select=true);
@@ -90,6 +98,12 @@ public:
 	virtual void moveEntity(int index, QList<RS_Entity *>& entList);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+    /**
+     * @brief removeEntities removes all given entities in one pass over
+     * the entity list with a single border update
+     * @return number of entities removed
+     */
+    virtual unsigned removeEntities(const std::unordered_set<RS_Entity*>& toRemove);
 
 	//!
 	//! \brief addRectangle add four lines to form a rectangle by
@@ -133,6 +147,7 @@ public:
     }
     virtual void adjustBorders(RS_Entity* entity);
     virtual void calculateBorders();
+    virtual void updateBorders();
     virtual void forcedCalculateBorders();
     virtual void updateDimensions( bool autoText=true);
     virtual void updateInserts();
@@ -176,6 +191,38 @@ public:
                                       RS2::ResolveLevel level=RS2::ResolveNone,
                                       double solidDist = RS_MAXDOUBLE) const;
 
+    /**
+     * @brief entitiesInRect candidates for window queries
+     * @return child entities whose bounding boxes intersect with area,
+     * in list order. Entities without finite borders, e.g. construction
+     * lines, are always included
+     */
+    std::vector<RS_Entity*> entitiesInRect(const LC_Rect& area) const;
+    /**
+     * @brief nearestEntities candidates for nearest entity queries
+     * @return up to k child entities with their bounding boxes closest
+     * to coord, sorted by increasing bounding box distance
+     */
+    std::vector<RS_Entity*> nearestEntities(const RS_Vector& coord,
+                                            unsigned k) const;
+    /**
+     * @brief updateSpatialIndex must be called after the borders of a
+     * child entity were changed in place
+     */
+    void updateSpatialIndex(RS_Entity* entity);
+    /**
+     * @brief childBordersGrown must be called after the borders of a
+     * child entity grew in place, e.g. a vertex was added to a polyline.
+     * Updates the spatial index and the borders of this container and
+     * passes the growth on to the parents, if the child is indexed.
+     */
+    void childBordersGrown(RS_Entity* child);
+    /**
+     * @brief invalidateSpatialIndex drops the spatial index, it's rebuilt
+     * on the next query
+     */
+    void invalidateSpatialIndex();
+
     virtual bool optimizeContours();
 
     virtual bool hasEndpointsWithinWindow(const RS_Vector& v1, const RS_Vector& v2);
@@ -195,6 +242,8 @@ public:
 
 
     virtual void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset);
+    /** refreshes the borders, the spatial index and the sub entities */
+    virtual void prepareDrawing(RS_GraphicView* view);
 
     friend std::ostream& operator << (std::ostream& os, RS_EntityContainer& ec);
 
@@ -229,6 +278,17 @@ public:
 	//! \}
 
 protected:
+    /**
+     * @brief useSpatialIndex builds the spatial index on demand
+     * @return true, if queries should go through the spatial index,
+     * false for small containers which are searched linearly
+     */
+    bool useSpatialIndex() const;
+    /**
+     * @brief entityPosition index of a child entity in the entity list
+     * @return -1, if entity is not a child of this container
+     */
+    int entityPosition(const RS_Entity* entity) const;
 
     /** entities in the container */
     QList<RS_Entity *> entities;
@@ -245,6 +305,15 @@ protected:
 private:
     int entIdx;
     bool autoDelete;
+    //! R-tree of the child entities, built on the first query
+    mutable LC_SpatialIndex spatialIndex;
+    //! list positions of the child entities, built on the first lookup
+    mutable std::unordered_map<const RS_Entity*, int> positions;
+
+    void updatePositions(int from);
+    void extendBorders(RS_Entity* entity);
+    bool isOnBorders(const RS_Entity* entity) const;
+    void correctBorders();
 };
 
 #endif
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <QMutex>
+#include <QMutexLocker>
+#include "rs_fontchar.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+
+namespace {
+//! maximum distance of the flattened arcs from the arcs, letters are
+//! 9 units high
+const double strokeTolerance = 0.01;
+
+void appendPoint(std::vector<std::vector<RS_Vector>>& strokes,
+				 const RS_Vector& start, const RS_Vector& v)
+{
+	// continue the last stroke, if this segment is connected
+	if (strokes.empty() || strokes.back().back().distanceTo(start) > RS_TOLERANCE)
+		strokes.push_back({start});
+	strokes.back().push_back(v);
+}
+
+void appendArc(std::vector<std::vector<RS_Vector>>& strokes,
+			   const RS_Vector& center, double radius,
+			   double angle1, double angleLength)
+{
+	double const da = 2.*acos(std::max(0., 1. - strokeTolerance/radius));
+	int const n = std::max(1, (int) ceil(fabs(angleLength)/std::max(da, 0.01)));
+	RS_Vector start = center + RS_Vector::polar(radius, angle1);
+	for (int i = 1; i <= n; ++i) {
+		RS_Vector const v = center + RS_Vector::polar(radius, angle1 + angleLength*i/n);
+		appendPoint(strokes, start, v);
+		start = v;
+	}
+}
+}
+
+const std::vector<std::vector<RS_Vector>>& RS_FontChar::getStrokes()
+{
+	if (flattened.load(std::memory_order_acquire))
+		return strokes;
+
+	// fonts are shared by documents being drawn and loaded in other threads
+	static QMutex mutex;
+	QMutexLocker lock(&mutex);
+	if (flattened.load(std::memory_order_relaxed))
+		return strokes;
+
+	for (RS_Entity* e = firstEntity(RS2::ResolveAll); e;
+		 e = nextEntity(RS2::ResolveAll)) {
+		switch (e->rtti()) {
+		case RS2::EntityArc: {
+			RS_Arc const* arc = static_cast<RS_Arc*>(e);
+			double const length = arc->getAngleLength();
+			appendArc(strokes, arc->getCenter(), arc->getRadius(), arc->getAngle1(),
+					  arc->isReversed() ? -length : length);
+			break;
+		}
+		case RS2::EntityCircle: {
+			RS_Circle const* circle = static_cast<RS_Circle*>(e);
+			appendArc(strokes, circle->getCenter(), circle->getRadius(), 0., 2.*M_PI);
+			break;
+		}
+		default:
+			if (e->getStartpoint().valid && e->getEndpoint().valid)
+				appendPoint(strokes, e->getStartpoint(), e->getEndpoint());
+			break;
+		}
+	}
+	flattened.store(true, std::memory_order_release);
+	return strokes;
+}
@@ -28,6 +28,8 @@
 #ifndef RS_FONTCHAR_H
 #define RS_FONTCHAR_H
 
+#include <atomic>
+#include <vector>
 #include "rs_block.h"
 
 
@@ -56,6 +58,13 @@ public:
         return RS2::EntityFontChar;
     }
 
+    /**
+     * @return The letter flattened to polylines in letter coordinates.
+     * Created on the first call and shared by all inserts of the letter,
+     * safe to call from several threads.
+     */
+    const std::vector<std::vector<RS_Vector>>& getStrokes();
+
 
     /*friend std::ostream& operator << (std::ostream& os, const RS_FontChar& b) {
        	os << " name: " << b.getName().latin1() << "\n";
@@ -65,6 +74,8 @@ public:
 
 
 protected:
+    std::vector<std::vector<RS_Vector>> strokes;
+    std::atomic<bool> flattened{false};
 };
 
 
@@ -25,6 +25,8 @@
 **********************************************************************/
 
 #include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include "rs_fontlist.h"
 #include "rs_debug.h"
 #include "rs_font.h"
@@ -117,8 +119,13 @@ RS_Font* RS_FontList::requestFont(const QString& name) {
 	for( auto const& f: fonts){
 
         if (f->getFileName()==name2) {
-            // Make sure this font is loaded into memory:
-            f->loadFont();
+            // Make sure this font is loaded into memory. Fonts are shared
+            // by documents loaded in worker threads, the letters are all
+            // generated at once so they are only read afterwards:
+            static QMutex mutex;
+            QMutexLocker lock(&mutex);
+            if (!f->loaded && f->loadFont())
+                f->generateAllFonts();
 			foundFont = f.get();
             break;
         }
@@ -24,6 +24,7 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <QDir>
 #include <QDebug>
 
@@ -50,6 +51,9 @@ blockList(true),paperScaleFixed(false)
 
     RS_SETTINGS->beginGroup("/Defaults");
     setUnit(RS_Units::stringToUnit(RS_SETTINGS->readEntry("/Unit", "None")));
+    // undo memory budget in MiB, 0: unlimited
+    int const undoLimit = RS_SETTINGS->readNumEntry("/UndoMemoryLimit", 256);
+    setMemoryLimit(undoLimit > 0 ? size_t(undoLimit)*1024*1024 : 0);
     RS_SETTINGS->endGroup();
     RS_SETTINGS->beginGroup("/Appearance");
     //$ISOMETRICGRID == $SNAPSTYLE
@@ -101,12 +105,8 @@ unsigned long int RS_Graphic::countLayerEntities(RS_Layer* layer) {
     int c=0;
 
 	if (layer) {
-		for(auto t: entities){
-
-			if (t->getLayer() &&
-                    t->getLayer()->getName()==layer->getName()) {
-                c+=t->countDeep();
-            }
+		for(auto t: getLayerEntities(layer)){
+            c+=t->countDeep();
         }
     }
 
@@ -115,6 +115,76 @@ unsigned long int RS_Graphic::countLayerEntities(RS_Layer* layer) {
 
 
 
+std::vector<RS_Entity*> RS_Graphic::getLayerEntities(RS_Layer* layer) {
+	if (!layerIndexValid) {
+		layerEntities.clear();
+		for(auto e: entities){
+			layerEntities[e->getLayer(false)].insert(e);
+		}
+		layerIndexValid = true;
+	}
+	auto it = layerEntities.find(layer);
+	if (it == layerEntities.end()) {
+		return {};
+	}
+	// the hash order would make the order of undo cycles and of the
+	// restored entities arbitrary
+	std::vector<RS_Entity*> ret{it->second.begin(), it->second.end()};
+	std::sort(ret.begin(), ret.end(),
+			  [this](RS_Entity const* a, RS_Entity const* b) {
+		return entityPosition(a) < entityPosition(b);
+	});
+	return ret;
+}
+
+
+
+void RS_Graphic::addToLayerIndex(RS_Entity* entity) {
+	if (layerIndexValid && entity) {
+		layerEntities[entity->getLayer(false)].insert(entity);
+	}
+}
+
+
+
+void RS_Graphic::removeFromLayerIndex(RS_Entity* entity) {
+	if (!layerIndexValid || !entity) {
+		return;
+	}
+	auto it = layerEntities.find(entity->getLayer(false));
+	if (it != layerEntities.end()) {
+		it->second.erase(entity);
+		if (it->second.empty()) {
+			layerEntities.erase(it);
+		}
+	}
+}
+
+
+
+void RS_Graphic::clearLayerIndex() {
+	layerEntities.clear();
+	layerIndexValid = false;
+}
+
+
+
+void RS_Graphic::entityLayerChanged(RS_Entity* entity, RS_Layer* previous) {
+	if (!layerIndexValid) {
+		return;
+	}
+	// only entities of this graphic are in the index
+	auto it = layerEntities.find(previous);
+	if (it != layerEntities.end() && it->second.erase(entity)) {
+		if (it->second.empty()) {
+			layerEntities.erase(it);
+		}
+		addToLayerIndex(entity);
+	}
+}
+
+
+
 /**
  * Removes the given layer and undoes all entities on it.
  */
@@ -122,14 +192,8 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 
     if (layer && layer->getName()!="0") {
 
-		std::vector<RS_Entity*> toRemove;
 		//find entities on layer
-		for(auto e: entities){
-			if (e->getLayer() &&
-                    e->getLayer()->getName()==layer->getName()) {
-				toRemove.push_back(e);
-            }
-        }
+		std::vector<RS_Entity*> toRemove = getLayerEntities(layer);
 		// remove all entities on that layer:
 		if(toRemove.size()){
 			startUndoCycle();
@@ -159,11 +223,21 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
 			e->setLayer("0");
 		}
 
+        layerEntities.erase(layer);
         layerList.remove(layer);
     }
 }
 
 
+void RS_Graphic::prepareDrawing(RS_GraphicView* view) {
+    RS_Document::prepareDrawing(view);
+    for (RS_Block* blk: blockList) {
+        blk->prepareDrawing(view);
+    }
+}
+
+
+
 /**
  * Clears all layers, blocks and entities of this graphic.
  * A default layer (0) is created.
@@ -504,6 +578,11 @@ bool RS_Graphic::loadTemplate(const QString &filename, RS2::FormatType type) {
  * Loads the given file into this graphic.
  */
 bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
+    return open(filename, type, nullptr);
+}
+
+bool RS_Graphic::open(const QString &filename, RS2::FormatType type,
+                      const std::function<bool(qint64, qint64)>& progress) {
     RS_DEBUG->print("RS_Graphic::open(%s)", filename.toLatin1().data());
 
         bool ret = false;
@@ -518,7 +597,7 @@ bool RS_Graphic::open(const QString &filename, RS2::FormatType type) {
     newDoc();
 
     // import file:
-    ret = RS_FileIO::instance()->fileImport(*this, filename, type);
+    ret = RS_FileIO::instance()->fileImport(*this, filename, type, progress);
 
     if( ret) {
         setModified(false);
@@ -917,6 +996,7 @@ bool RS_Graphic::fitToPage() {
 void RS_Graphic::addEntity(RS_Entity* entity)
 {
     RS_EntityContainer::addEntity(entity);
+    addToLayerIndex(entity);
     if( entity->rtti() == RS2::EntityBlock ||
             entity->rtti() == RS2::EntityContainer){
         RS_EntityContainer* e=static_cast<RS_EntityContainer*>(entity);
@@ -927,6 +1007,59 @@ void RS_Graphic::addEntity(RS_Entity* entity)
 }
 
 
+void RS_Graphic::appendEntity(RS_Entity* entity)
+{
+    RS_EntityContainer::appendEntity(entity);
+    addToLayerIndex(entity);
+}
+
+
+void RS_Graphic::prependEntity(RS_Entity* entity)
+{
+    RS_EntityContainer::prependEntity(entity);
+    addToLayerIndex(entity);
+}
+
+
+void RS_Graphic::insertEntity(int index, RS_Entity* entity)
+{
+    RS_EntityContainer::insertEntity(index, entity);
+    addToLayerIndex(entity);
+}
+
+
+void RS_Graphic::setEntityAt(int index, RS_Entity* en)
+{
+    removeFromLayerIndex(entities.at(index));
+    RS_EntityContainer::setEntityAt(index, en);
+    addToLayerIndex(en);
+}
+
+
+bool RS_Graphic::removeEntity(RS_Entity* entity)
+{
+    // before the entity is deleted
+    removeFromLayerIndex(entity);
+    return RS_EntityContainer::removeEntity(entity);
+}
+
+
+unsigned RS_Graphic::removeEntities(const std::unordered_set<RS_Entity*>& toRemove)
+{
+    for (RS_Entity* e: toRemove) {
+        removeFromLayerIndex(e);
+    }
+    return RS_EntityContainer::removeEntities(toRemove);
+}
+
+
+void RS_Graphic::clear()
+{
+    RS_EntityContainer::clear();
+    clearLayerIndex();
+}
+
+
 /**
  * Dumps the entities to stdout.
  */
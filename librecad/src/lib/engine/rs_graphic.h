@@ -29,6 +29,9 @@
 #ifndef RS_GRAPHIC_H
 #define RS_GRAPHIC_H
 
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include <QDateTime>
 #include "rs_blocklist.h"
 #include "rs_layerlist.h"
@@ -59,6 +62,13 @@ public:
     }
 
     virtual unsigned long int countLayerEntities(RS_Layer* layer);
+    /**
+     * @return the entities of this graphic (not of sub containers) on
+     * the given layer, in the order of the entity list
+     */
+    std::vector<RS_Entity*> getLayerEntities(RS_Layer* layer);
+    /** prepares the blocks as well, they are drawn by the inserts */
+    virtual void prepareDrawing(RS_GraphicView* view);
 
     virtual RS_LayerList* getLayerList() {
         return &layerList;
@@ -71,11 +81,19 @@ public:
     virtual bool save(bool isAutoSave = false);
     virtual bool saveAs(const QString& filename, RS2::FormatType type, bool force = false);
     virtual bool open(const QString& filename, RS2::FormatType type);
+    /**
+     * Opens a file like open(filename, type). \p progress receives the
+     * bytes read and the size of the file, the import is cancelled if
+     * it returns false.
+     */
+    bool open(const QString& filename, RS2::FormatType type,
+              const std::function<bool(qint64, qint64)>& progress);
     bool loadTemplate(const QString &filename, RS2::FormatType type);
 
         // Wrappers for Layer functions:
     void clearLayers() {
                 layerList.clear();
+                clearLayerIndex();
         }
     unsigned countLayers() const {
         return layerList.count();
@@ -96,6 +114,14 @@ public:
                 layerList.add(layer);
         }
     virtual void addEntity(RS_Entity* entity);
+    virtual void appendEntity(RS_Entity* entity);
+    virtual void prependEntity(RS_Entity* entity);
+    virtual void insertEntity(int index, RS_Entity* entity);
+    virtual void setEntityAt(int index, RS_Entity* en);
+    virtual bool removeEntity(RS_Entity* entity);
+    virtual unsigned removeEntities(const std::unordered_set<RS_Entity*>& toRemove);
+    virtual void clear();
+    virtual void entityLayerChanged(RS_Entity* entity, RS_Layer* previous);
     virtual void removeLayer(RS_Layer* layer);
     virtual void editLayer(RS_Layer* layer, const RS_Layer& source) {
                 layerList.edit(layer, source);
@@ -303,6 +329,10 @@ virtual QDateTime getModifyTime(void){
 private:
 
         bool BackupDrawingFile(const QString &filename);
+        void addToLayerIndex(RS_Entity* entity);
+        void removeFromLayerIndex(RS_Entity* entity);
+        void clearLayerIndex();
+
         QDateTime modifiedTime;
         QString currentFileName; //keep a copy of filename for the modifiedTime
 
@@ -312,6 +342,9 @@ private:
         RS2::CrosshairType crosshairType; //corss hair type used by isometric grid
         //if set to true, will refuse to modify paper scale
         bool paperScaleFixed;
+        //! entities by layer, built on the first layer query
+        std::unordered_map<RS_Layer*, std::unordered_set<RS_Entity*>> layerEntities;
+        bool layerIndexValid = false;
 };
 
 
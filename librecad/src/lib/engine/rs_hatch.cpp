@@ -25,6 +25,7 @@
 **********************************************************************/
 #include <memory>
 #include <QPainterPath>
+#include <QTransform>
 #include <QBrush>
 #include <QString>
 #include "rs_hatch.h"
@@ -132,6 +133,8 @@ bool RS_Hatch::isContainer() const {
  */
 void RS_Hatch::calculateBorders() {
     RS_DEBUG->print("RS_Hatch::calculateBorders");
+    // the boundary may have changed
+    fillPathValid = false;
 
     activateContour(true);
 
@@ -145,6 +148,12 @@ void RS_Hatch::calculateBorders() {
 
 
 
+void RS_Hatch::updateBorders() {
+    calculateBorders();
+}
+
+
+
 /**
  * Updates the Hatch. Called when the
  * hatch or it's data, position, alignment, .. changes.
@@ -547,168 +556,153 @@ void RS_Hatch::activateContour(bool on) {
 
 //#include<QDebug>
 /**
- * Overrides drawing of subentities. This is only ever called for solid fills.
+ * Optimizes the loops and passes the layer on to loops and edges,
+ * so that drawing does not modify the hatch.
  */
-void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
-
-    if (!data.solid) {
-		for(auto se: entities){
-
-            view->drawEntity(painter,se);
-        }
-        return;
-    }
-
-    //area of solid fill. Use polygon approximation, except trivial cases
-    QPainterPath path;
-    QList<QPolygon> paClosed;
-    QPolygon pa;
-//    QPolygon jp;   // jump points
-
-    // loops:
-    if (needOptimization==true) {
-		for(auto l: entities){
-
-            if (l->rtti()==RS2::EntityContainer) {
-                RS_EntityContainer* loop = (RS_EntityContainer*)l;
+void RS_Hatch::prepareContours() {
+	for(auto l: entities){
+        l->setLayer(getLayer());
+        if (l->rtti()==RS2::EntityContainer) {
+            RS_EntityContainer* loop = (RS_EntityContainer*)l;
 
+            if (needOptimization) {
                 loop->optimizeContours();
+                fillPathValid = false;
             }
+            for(auto e: *loop)
+                e->setLayer(getLayer());
         }
-        needOptimization = false;
     }
+    needOptimization = false;
+}
 
+void RS_Hatch::prepareDrawing(RS_GraphicView* view) {
+    prepareContours();
+    if (data.solid && !fillPathValid) {
+        createFillPath(fillPath);
+        fillPathValid = true;
+    }
+    RS_EntityContainer::prepareDrawing(view);
+}
+
+/**
+ * Builds the boundary of a solid fill in graph coordinates, with y
+ * negated to match the orientation of the screen.
+ */
+void RS_Hatch::createFillPath(QPainterPath& path) const {
+    path = QPainterPath();
     // loops:
 	for(auto l: entities){
-        l->setLayer(getLayer());
-
-        if (l->rtti()==RS2::EntityContainer) {
-            RS_EntityContainer* loop = (RS_EntityContainer*)l;
 
-            // edges:
-			for(auto e: *loop){
+        if (l->rtti()!=RS2::EntityContainer)
+            continue;
+        RS_EntityContainer* loop = (RS_EntityContainer*)l;
+        // edges are connected to the open subpath of the loop
+        bool open = false;
+		for(auto e: *loop){
+            QPainterPath edge;
+            switch (e->rtti()) {
+            case RS2::EntityLine:
+                edge.moveTo(e->getStartpoint().x, -e->getStartpoint().y);
+                edge.lineTo(e->getEndpoint().x, -e->getEndpoint().y);
+                break;
+
+            case RS2::EntityArc: {
+                RS_Arc* arc=static_cast<RS_Arc*>(e);
+                RS_Vector const& c = arc->getCenter();
+                double const r = arc->getRadius();
+                QRectF const rect(c.x - r, -c.y - r, 2.*r, 2.*r);
+                double const a1 = RS_Math::rad2deg(arc->getAngle1());
+                double const sweep = RS_Math::rad2deg(arc->getAngleLength());
+                edge.arcMoveTo(rect, a1);
+                edge.arcTo(rect, a1, arc->isReversed()?-sweep:sweep);
+            }
+                break;
 
-                e->setLayer(getLayer());
-                switch (e->rtti()) {
-                case RS2::EntityLine: {
-                    QPoint pt1(RS_Math::round(view->toGuiX(e->getStartpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getStartpoint().y)));
-                    QPoint pt2(RS_Math::round(view->toGuiX(e->getEndpoint().x)),
-                               RS_Math::round(view->toGuiY(e->getEndpoint().y)));
-
-//                    if (! (pa.size()>0 && (pa.last() - pt1).manhattanLength()<=2)) {
-//                        jp<<pt1;
-//                    }
-                    if(pa.size() && (pa.last()-pt1).manhattanLength()>=1)
-                        pa<<pt1;
-                    pa<<pt2;
+            case RS2::EntityCircle: {
+                RS_Circle* circle = static_cast<RS_Circle*>(e);
+                RS_Vector const& c = circle->getCenter();
+                path.addEllipse(QPointF(c.x, -c.y), circle->getRadius(), circle->getRadius());
+                open = false;
+            }
+                continue;
+
+            case RS2::EntityEllipse: {
+                auto ellipse=static_cast<RS_Ellipse*>(e);
+                double const ra = ellipse->getMajorRadius();
+                double const rb = ellipse->getMinorRadius();
+                QRectF const rect(-ra, -rb, 2.*ra, 2.*rb);
+                // rotated about and moved to the center
+                double const angle = ellipse->getAngle();
+                RS_Vector const& c = ellipse->getCenter();
+                QTransform const placement(cos(angle), -sin(angle),
+                                           sin(angle), cos(angle),
+                                           c.x, -c.y);
+                if (ellipse->isArc()) {
+                    double const a1 = RS_Math::rad2deg(ellipse->getAngle1());
+                    double const sweep = RS_Math::rad2deg(ellipse->getAngleLength());
+                    edge.arcMoveTo(rect, a1);
+                    edge.arcTo(rect, a1, ellipse->isReversed()?-sweep:sweep);
+                    edge = placement.map(edge);
+                } else {
+                    edge.addEllipse(rect);
+                    path.addPath(placement.map(edge));
+                    open = false;
+                    continue;
                 }
-                    break;
-
-                case RS2::EntityArc: {
-//                    QPoint pt1(RS_Math::round(view->toGuiX(e->getStartpoint().x)),
-//                               RS_Math::round(view->toGuiY(e->getStartpoint().y)));
-//                    if (! (pa.size()>0 && (pa.last() - pt1).manhattanLength()<=2)) {
-//                        jp<<pt1;
-//                    }
-
-                    QPolygon pa2;
-                    RS_Arc* arc=static_cast<RS_Arc*>(e);
+            }
+                break;
+            default:
+                continue;
+            }
 
-                    painter->createArc(pa2, view->toGui(arc->getCenter()),
-                                       view->toGuiDX(arc->getRadius())
-                                       ,arc->getAngle1(),arc->getAngle2(),arc->isReversed());
-                    if(pa.size() &&pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
+            if (open) {
+                path.connectPath(edge);
+            } else {
+                path.addPath(edge);
+                open = true;
+            }
+        }
+        if (open)
+            path.closeSubpath();
+    }
+}
 
-                }
-                    break;
-
-                case RS2::EntityCircle: {
-                    RS_Circle* circle = static_cast<RS_Circle*>(e);
-//                    QPoint pt1(RS_Math::round(view->toGuiX(circle->getCenter().x+circle->getRadius())),
-//                               RS_Math::round(view->toGuiY(circle->getCenter().y)));
-//                    if (! (pa.size()>0 && (pa.last() - pt1).manhattanLength()<=2)) {
-//                        jp<<pt1;
-//                    }
-
-                    RS_Vector c=view->toGui(circle->getCenter());
-                    double r=view->toGuiDX(circle->getRadius());
-#if QT_VERSION >= 0x040400
-                    path.addEllipse(QPoint(c.x,c.y),r,r);
-#else
-                    path.addEllipse(c.x - r, c.y + r, 2.*r, 2.*r);
-//                    QPolygon pa2;
-//                    painter->createArc(pa2, view->toGui(circle->getCenter()),
-//                                       view->toGuiDX(circle->getRadius()),
-//                                       0.0,
-//                                       2*M_PI,
-//                                       false);
-//                    pa<<pa2;
-#endif
-                }
-                    break;
-                case RS2::EntityEllipse:
-                if(static_cast<RS_Ellipse*>(e)->isArc()) {
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle()
-                                           ,ellipse->getAngle1(),ellipse->getAngle2(),ellipse->isReversed()
-                                           );
-//                    qDebug()<<"ellipse: "<<ellipse->getCenter().x<<","<<ellipse->getCenter().y;
-//                    qDebug()<<"ellipse: pa2.size()="<<pa2.size();
-//                    qDebug()<<"ellipse: pa2="<<pa2;
-                    if(pa.size() && pa2.size()&&(pa.last()-pa2.first()).manhattanLength()<1)
-                        pa2.remove(0,1);
-                    pa<<pa2;
-                }else{
-                    QPolygon pa2;
-                    auto ellipse=static_cast<RS_Ellipse*>(e);
-                    painter->createEllipse(pa2,
-                                           view->toGui(ellipse->getCenter()),
-                                           view->toGuiDX(ellipse->getMajorRadius()),
-                                           view->toGuiDX(ellipse->getMinorRadius()),
-                                           ellipse->getAngle(),
-                                           ellipse->getAngle1(), ellipse->getAngle2(),
-                                           ellipse->isReversed()
-                                           );
-                    path.addPolygon(pa2);
-                }
-                    break;
-                default:
-                    break;
-                }
-//                qDebug()<<"pa="<<pa;
-                if( pa.size()>2 && pa.first() == pa.last()) {
-                    paClosed<<pa;
-                    pa.clear();
-                }
+/**
+ * Overrides drawing of subentities. This is only ever called for solid fills.
+ */
+void RS_Hatch::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patternOffset*/) {
 
-            }
+    if (!data.solid) {
+		for(auto se: entities){
 
+            view->drawEntity(painter,se);
         }
-    }
-    if(pa.size()>2){
-        pa<<pa.first();
-        paClosed<<pa;
+        return;
     }
 
-    for(auto& p:paClosed){
-        path.addPolygon(p);
-    }
+    // loops:
+    if (needOptimization==true)
+        prepareContours();
+
+    // the boundary is cached by prepareDrawing(), views drawing without
+    // preparing build it for each call
+    QPainterPath path;
+    if (!fillPathValid)
+        createFillPath(path);
+
+    // graph coordinates, with y negated, to screen coordinates
+    RS_Vector const& factor = view->getFactor();
+    QTransform const toGui(factor.x, 0., 0., factor.y,
+                           view->getOffsetX(),
+                           view->getHeight() - view->getOffsetY());
 
     //bug#474, restore brush after solid fill
     const QBrush brush(painter->brush());
     const RS_Pen pen=painter->getPen();
     painter->setBrush(pen.getColor());
     painter->disablePen();
-    painter->drawPath(path);
+    painter->drawPath(fillPathValid?fillPath:path, toGui);
     painter->setBrush(brush);
     painter->setPen(pen);
 
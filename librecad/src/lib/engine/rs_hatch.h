@@ -28,6 +28,7 @@
 #ifndef RS_HATCH_H
 #define RS_HATCH_H
 
+#include <QPainterPath>
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
 
@@ -110,6 +111,7 @@ public:
         }
         void setSolid(bool solid) {
                 data.solid = solid;
+                fillPathValid = false;
         }
 
         QString getPattern() {
@@ -135,6 +137,8 @@ public:
         double getTotalArea();
 
         virtual void calculateBorders();
+        /** the contour has to be activated, see calculateBorders() */
+        virtual void updateBorders();
         void update();
         int getUpdateError() {
                 return updateError;
@@ -143,6 +147,7 @@ public:
 
         virtual void draw(RS_Painter* painter, RS_GraphicView* view,
                           double& patternOffset);
+        virtual void prepareDrawing(RS_GraphicView* view);
 
         //	virtual double getLength() {
         //		return -1.0;
@@ -166,11 +171,17 @@ public:
         friend std::ostream& operator << (std::ostream& os, const RS_Hatch& p);
 
 protected:
+        void prepareContours();
+        void createFillPath(QPainterPath& path) const;
+
         RS_HatchData data;
         RS_EntityContainer* hatch;
         bool updateRunning;
         bool needOptimization;
         int  updateError;
+        //! boundary of a solid fill, see createFillPath()
+        QPainterPath fillPath;
+        bool fillPathValid=false;
 };
 
 #endif
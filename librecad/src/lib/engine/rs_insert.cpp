@@ -25,15 +25,24 @@
 **********************************************************************/
 
 
+#include <algorithm>
+#include <cmath>
 #include "rs_insert.h"
 
 #include "rs_arc.h"
 #include "rs_circle.h"
 #include "rs_ellipse.h"
 #include "rs_block.h"
+#include "rs_fontchar.h"
 #include "rs_graphic.h"
 #include "rs_layer.h"
+#include "rs_line.h"
 #include "rs_math.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_graphicview.h"
+#include "rs_painter.h"
 
 RS_InsertData::RS_InsertData(const QString& _name,
 							 RS_Vector _insertionPoint,
@@ -87,6 +96,9 @@ RS_Entity* RS_Insert::clone() const{
 /**
  * Updates the entity buffer of this insert entity. This method
  * needs to be called whenever the block this insert is based on changes.
+ *
+ * Instanced inserts (see canInstance()) only update their borders here,
+ * their entities are created by flatten() when they are needed.
  */
 void RS_Insert::update() {
 
@@ -100,6 +112,8 @@ void RS_Insert::update() {
         }
 
     clear();
+    subEntities.container.reset();
+    instanced = false;
 
     RS_Block* blk = getBlockForInsert();
 	if (!blk) {
@@ -118,132 +132,552 @@ void RS_Insert::update() {
                 return;
         }
 
-    RS_Pen tmpPen;
-
-        /*QListIterator<RS_Entity> it = createIterator();
-    RS_Entity* e;
-	while ( (e = it.current())  ) {
-        ++it;*/
-
         RS_DEBUG->print("RS_Insert::update: cols: %d, rows: %d",
                 data.cols, data.rows);
         RS_DEBUG->print("RS_Insert::update: block has %d entities",
                 blk->count());
-//int i_en_counts=0;
+
+    if (data.updateMode!=RS2::PreviewUpdate) {
+        // sub-inserts of the block, their borders are part of the block borders
+        bool subInserts = false;
 		for(auto e: *blk){
+            if (e->rtti()==RS2::EntityInsert) {
+				static_cast<RS_Insert*>(e)->update();
+                subInserts = true;
+            }
+        }
+        if (subInserts) {
+            blk->calculateBorders();
+        }
+    }
+
+    if (canInstance(blk)) {
+        RS_DEBUG->print("RS_Insert::update: instanced");
+        instanced = true;
+        calculateInstanceBorders();
+        return;
+    }
+
+	for(auto e: *blk){
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+                appendEntity(createEntity(e, blk, c, r));
+            }
+        }
+    }
+    calculateBorders();
+
+        RS_DEBUG->print("RS_Insert::update: OK");
+}
+
+
+
+/**
+ * Creates the transformed copy of a block entity for the given
+ * column and row of this insert.
+ */
+RS_Entity* RS_Insert::createEntity(RS_Entity* e, RS_Block* blk, int c, int r) const {
+    RS_Entity* ne;
+    if ( (data.scaleFactor.x - data.scaleFactor.y)>1.0e-6) {
+        if (e->rtti()== RS2::EntityArc) {
+			RS_Arc* a= static_cast<RS_Arc*>(e);
+			ne = new RS_Ellipse{nullptr,
+			a->getCenter(), {a->getRadius(), 0.}, 1,
+					a->getAngle1(), a->getAngle2(),
+					a->isReversed()};
+            ne->setLayer(e->getLayer());
+            ne->setPen(e->getPen(false));
+        } else if (e->rtti()== RS2::EntityCircle) {
+			RS_Circle* a= static_cast<RS_Circle*>(e);
+			ne = new RS_Ellipse{nullptr,
+			a->getCenter(), {a->getRadius(), 0.}, 1, 0., 2.*M_PI
+		};
+            ne->setLayer(e->getLayer());
+            ne->setPen(e->getPen(false));
+        } else
+            ne = e->clone();
+    } else
+        ne = e->clone();
+    ne->initId();
+    transformEntity(ne, blk, c, r);
+    return ne;
+}
+
+
+
+/**
+ * Transforms the copy ne of a block entity to the given column and row
+ * of this insert and gives it the attributes it has in this insert.
+ */
+void RS_Insert::transformEntity(RS_Entity* ne, RS_Block* blk, int c, int r) const {
+    ne->setUpdateEnabled(false);
+    // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
+    RS_Layer *l= ne->getLayer();//special fontchar block don't have
+	if (l  && ne->getLayer()->getName() == "0")
+        ne->setLayer(this->getLayer());
+    // the copy only refers to this insert, it doesn't change it
+    ne->setParent(const_cast<RS_Insert*>(this));
+    ne->setVisible(getFlag(RS2::FlagVisible));
+
+    // Move:
+    if (fabs(data.scaleFactor.x)>1.0e-6 &&
+            fabs(data.scaleFactor.y)>1.0e-6) {
+        ne->move(data.insertionPoint +
+                 RS_Vector(data.spacing.x/data.scaleFactor.x*c,
+                           data.spacing.y/data.scaleFactor.y*r));
+    }
+    else {
+        ne->move(data.insertionPoint);
+    }
+    // Move because of block base point:
+    ne->move(blk->getBasePoint()*-1);
+    // Scale:
+    ne->scale(data.insertionPoint, data.scaleFactor);
+    // Rotate:
+    ne->rotate(data.insertionPoint, data.angle);
+    // Select:
+    ne->setSelected(isSelected());
+
+    // individual entities can be on indiv. layers
+    RS_Pen tmpPen = ne->getPen(false);
+
+    // color from block (free floating):
+    if (tmpPen.getColor()==RS_Color(RS2::FlagByBlock)) {
+        tmpPen.setColor(getPen().getColor());
+    }
+
+    // line width from block (free floating):
+    if (tmpPen.getWidth()==RS2::WidthByBlock) {
+        tmpPen.setWidth(getPen().getWidth());
+    }
+
+    // line type from block (free floating):
+    if (tmpPen.getLineType()==RS2::LineByBlock) {
+        tmpPen.setLineType(getPen().getLineType());
+    }
+
+    // now that we've evaluated all flags, let's strip them:
+    // TODO: strip all flags (width, line type)
+    //tmpPen.setColor(tmpPen.getColor().stripFlags());
+
+    ne->setPen(tmpPen);
+
+    ne->setUpdateEnabled(true);
+
+    if (data.updateMode!=RS2::PreviewUpdate) {
+        if (ne->rtti()==RS2::EntityInsert
+                && static_cast<RS_Insert*>(ne)->isInstanced()) {
+            // the block of an instanced insert is up to date already
+            static_cast<RS_Insert*>(ne)->calculateInstanceBorders();
+        } else {
+            ne->update();
+        }
+    }
+}
+
+
+
+namespace {
+/**
+ * Calls func with a copy of e on the stack, after it is prepared by
+ * transform.
+ *
+ * @param owner polyline or insert e is part of. Its pen and layer are
+ *    used unless e has its own.
+ */
+template <class T, class Transform>
+void withCopy(RS_Entity* e, RS_Entity const* owner, Transform const& transform,
+              std::function<void(RS_Entity*)> const& func) {
+    T ne(*static_cast<T*>(e));
+    // the copy must not remove itself from the undo cycle of e
+    ne.setUndoCycle(nullptr);
+    if (owner) {
+        if (!ne.getPen(false).isValid()) {
+            ne.setPen(owner->getPen(false));
+        }
+        if (!ne.getLayer(false)) {
+            ne.setLayer(owner->getLayer(false));
+        }
+    }
+    transform(&ne);
+    func(&ne);
+}
+}
+
+
+
+/**
+ * Calls func with a copy of the block entity e transformed to the given
+ * column and row, like createEntity() but without allocating: the copy is
+ * only valid during the call. Polylines and flattened inserts are passed
+ * on entity by entity.
+ * Only entities of instanced inserts (see canInstance()) are supported.
+ */
+void RS_Insert::forInstance(RS_Entity* e, RS_Block* blk, int c, int r,
+                            std::function<void(RS_Entity*)> const& func,
+                            RS_Entity const* owner) {
+    auto const transform = [this, blk, c, r](RS_Entity* ne) {
+        transformEntity(ne, blk, c, r);
+    };
+    switch (e->rtti()) {
+    case RS2::EntityPoint:
+        withCopy<RS_Point>(e, owner, transform, func);
+        break;
+    case RS2::EntityLine:
+        withCopy<RS_Line>(e, owner, transform, func);
+        break;
+    case RS2::EntityArc:
+        withCopy<RS_Arc>(e, owner, transform, func);
+        break;
+    case RS2::EntityCircle:
+        withCopy<RS_Circle>(e, owner, transform, func);
+        break;
+    case RS2::EntityEllipse:
+        withCopy<RS_Ellipse>(e, owner, transform, func);
+        break;
+    case RS2::EntitySolid:
+        withCopy<RS_Solid>(e, owner, transform, func);
+        break;
+    case RS2::EntityInsert:
+        // a copy would share the entities of a flattened insert
+        if (static_cast<RS_Insert*>(e)->isInstanced()) {
+            withCopy<RS_Insert>(e, owner, transform, func);
+            break;
+        }
+        // fall through
+    case RS2::EntityPolyline:
+        for (RS_Entity* s: *static_cast<RS_EntityContainer*>(e)) {
+            forInstance(s, blk, c, r, func, e);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+
+
+/**
+ * @return true, if this insert can refer to the block geometry instead
+ * of holding copies of it: the scale factor is uniform (so distances
+ * from the block can be scaled) and the block only contains entities
+ * which don't need to be regenerated when they're transformed.
+ * Font letters are always instanced, they're drawn from the flattened
+ * letter (see RS_FontChar::getStrokes()). Previews are short lived and
+ * always hold their copies.
+ */
+bool RS_Insert::canInstance(RS_Block* blk) const {
+    if (data.updateMode==RS2::PreviewUpdate) {
+        return false;
+    }
+    if (blk->rtti()==RS2::EntityFontChar) {
+        return true;
+    }
+    if (data.blockSource || !isUniform()) {
+        return false;
+    }
+	for(auto e: *blk){
+        switch (e->rtti()) {
+        case RS2::EntityPoint:
+        case RS2::EntityLine:
+        case RS2::EntityPolyline:
+        case RS2::EntityArc:
+        case RS2::EntityCircle:
+        case RS2::EntityEllipse:
+        case RS2::EntitySolid:
+            break;
+        case RS2::EntityInsert:
+            if (!static_cast<RS_Insert*>(e)->isInstanced()) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+bool RS_Insert::isUniform() const {
+    return fabs(fabs(data.scaleFactor.x) - fabs(data.scaleFactor.y))<=1.0e-6;
+}
+
+
+
+/**
+ * @return true, if queries are answered from the block geometry. Distances
+ * in the block can only be scaled for uniform scale factors, instanced
+ * letters with other scale factors are answered from their strokes.
+ */
+bool RS_Insert::usesBlockGeometry() const {
+    return instanced && isUniform();
+}
+
+
+
+/**
+ * Creates the entities of an instanced insert. The entities are kept
+ * until the next update().
+ */
+void RS_Insert::flatten() {
+    if (!instanced) {
+        return;
+    }
+    instanced = false;
+    subEntities.container.reset();
+    RS_Block* blk = getBlockForInsert();
+    if (!blk) {
+        return;
+    }
+    RS_DEBUG->print("RS_Insert::flatten: name: %s", data.name.toLatin1().data());
+	for(auto e: *blk){
         for (int c=0; c<data.cols; ++c) {
-//            RS_DEBUG->print("RS_Insert::update: col %d", c);
             for (int r=0; r<data.rows; ++r) {
-//                i_en_counts++;
-//                RS_DEBUG->print("RS_Insert::update: row %d", r);
+                appendEntity(createEntity(e, blk, c, r));
+            }
+        }
+    }
+    calculateBorders();
+}
 
-                if (e->rtti()==RS2::EntityInsert &&
-                    data.updateMode!=RS2::PreviewUpdate) {
 
-//                                        RS_DEBUG->print("RS_Insert::update: updating sub-insert");
-					static_cast<RS_Insert*>(e)->update();
+
+/**
+ * @return the entities flatten() would create, kept apart from the
+ * entities of this insert until the next update(). Queries resolving
+ * an instanced insert return them without changing the insert.
+ */
+const RS_EntityContainer& RS_Insert::getSubEntities() const {
+    if (!subEntities.container) {
+        subEntities.container.reset(new RS_EntityContainer(nullptr, true));
+        RS_Block* blk = getBlockForInsert();
+        if (blk) {
+			for(auto e: *blk){
+                for (int c=0; c<data.cols; ++c) {
+                    for (int r=0; r<data.rows; ++r) {
+                        subEntities.container->appendEntity(createEntity(e, blk, c, r));
+                    }
                 }
+            }
+        }
+    }
+    return *subEntities.container;
+}
+
+
 
-//                                RS_DEBUG->print("RS_Insert::update: cloning entity");
-
-                RS_Entity* ne;
-                if ( (data.scaleFactor.x - data.scaleFactor.y)>1.0e-6) {
-                    if (e->rtti()== RS2::EntityArc) {
-						RS_Arc* a= static_cast<RS_Arc*>(e);
-						ne = new RS_Ellipse{this,
-						a->getCenter(), {a->getRadius(), 0.}, 1,
-								a->getAngle1(), a->getAngle2(),
-								a->isReversed()};
-                        ne->setLayer(e->getLayer());
-                        ne->setPen(e->getPen(false));
-                    } else if (e->rtti()== RS2::EntityCircle) {
-						RS_Circle* a= static_cast<RS_Circle*>(e);
-						ne = new RS_Ellipse{this,
-						a->getCenter(), {a->getRadius(), 0.}, 1, 0., 2.*M_PI
-					};
-                        ne->setLayer(e->getLayer());
-                        ne->setPen(e->getPen(false));
-                    } else
-                        ne = e->clone();
-                } else
-                    ne = e->clone();
-                ne->initId();
-                ne->setUpdateEnabled(false);
-                // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
-                RS_Layer *l= ne->getLayer();//special fontchar block don't have
-				if (l  && ne->getLayer()->getName() == "0")
-                    ne->setLayer(this->getLayer());
-                ne->setParent(this);
-                ne->setVisible(getFlag(RS2::FlagVisible));
-
-//                                RS_DEBUG->print("RS_Insert::update: transforming entity");
-
-                // Move:
-//                                RS_DEBUG->print("RS_Insert::update: move 1");
-                if (fabs(data.scaleFactor.x)>1.0e-6 &&
-                        fabs(data.scaleFactor.y)>1.0e-6) {
-                    ne->move(data.insertionPoint +
-                             RS_Vector(data.spacing.x/data.scaleFactor.x*c,
-                                       data.spacing.y/data.scaleFactor.y*r));
+/**
+ * @return coordinate in the block transformed to the given column and
+ * row of this insert, see createEntity()
+ */
+RS_Vector RS_Insert::toInsert(const RS_Vector& v, int c, int r) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Vector ret = v - blk->getBasePoint();
+    ret.x *= data.scaleFactor.x;
+    ret.y *= data.scaleFactor.y;
+    ret += RS_Vector(data.spacing.x*c, data.spacing.y*r);
+    ret.rotate(data.angle);
+    return ret + data.insertionPoint;
+}
+
+
+
+/**
+ * @return coordinate transformed from the given column and row of this
+ * insert back into the block
+ */
+RS_Vector RS_Insert::toBlock(const RS_Vector& v, int c, int r) const {
+    RS_Block* blk = getBlockForInsert();
+    RS_Vector ret = v - data.insertionPoint;
+    ret.rotate(-data.angle);
+    ret -= RS_Vector(data.spacing.x*c, data.spacing.y*r);
+    ret.x /= data.scaleFactor.x;
+    ret.y /= data.scaleFactor.y;
+    return ret + blk->getBasePoint();
+}
+
+
+
+/**
+ * Finds the closest point of the block geometry in all columns and rows.
+ *
+ * @param query nearest point query on the block in block coordinates,
+ *    returning the distance in block coordinates
+ */
+RS_Vector RS_Insert::getNearestInBlock(const RS_Vector& coord, double* dist,
+        std::function<RS_Vector(RS_Block*, const RS_Vector&, double*)> const& query) const {
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector closestPoint(false);
+    RS_Block* blk = getBlockForInsert();
+    if (blk) {
+        double const factor = fabs(data.scaleFactor.x);
+        for (int c=0; c<data.cols; ++c) {
+            for (int r=0; r<data.rows; ++r) {
+                double curDist = RS_MAXDOUBLE;
+                RS_Vector const point = query(blk, toBlock(coord, c, r), &curDist);
+                if (point.valid && curDist*factor<minDist) {
+                    closestPoint = toInsert(point, c, r);
+                    minDist = curDist*factor;
                 }
-                else {
-                    ne->move(data.insertionPoint);
+            }
+        }
+    }
+    if (dist) {
+        *dist = minDist;
+    }
+    return closestPoint;
+}
+
+
+
+/**
+ * Borders of an instanced insert are taken from the block borders.
+ * They only change with the transformation or the block, so they're
+ * calculated by update().
+ */
+void RS_Insert::calculateInstanceBorders() {
+    resetBorders();
+    RS_Block* blk = getBlockForInsert();
+    if (!blk || blk->getMin().x > blk->getMax().x
+            || data.cols < 1 || data.rows < 1) {
+        return;
+    }
+    // block borders are only exact in the insert for multiples of 90 degrees
+    bool const rightAngle =
+            fabs(remainder(data.angle, M_PI_2)) < RS_TOLERANCE_ANGLE;
+    RS_Vector const corners[] = {
+        blk->getMin(), {blk->getMax().x, blk->getMin().y},
+        blk->getMax(), {blk->getMin().x, blk->getMax().y}
+    };
+    // the outermost columns and rows
+    int const cols[] = {0, data.cols - 1};
+    int const rows[] = {0, data.rows - 1};
+    for (int c: cols) {
+        for (int r: rows) {
+            if (blk->rtti()==RS2::EntityFontChar) {
+                for (auto const& stroke: static_cast<RS_FontChar*>(blk)->getStrokes()) {
+                    for (RS_Vector const& v: stroke) {
+                        RS_Vector const vp = toInsert(v, c, r);
+                        minV = RS_Vector::minimum(minV, vp);
+                        maxV = RS_Vector::maximum(maxV, vp);
+                    }
                 }
-                // Move because of block base point:
-//                                RS_DEBUG->print("RS_Insert::update: move 2");
-                ne->move(blk->getBasePoint()*-1);
-                // Scale:
-//                                RS_DEBUG->print("RS_Insert::update: scale");
-                ne->scale(data.insertionPoint, data.scaleFactor);
-                // Rotate:
-//                                RS_DEBUG->print("RS_Insert::update: rotate");
-                ne->rotate(data.insertionPoint, data.angle);
-                // Select:
-                ne->setSelected(isSelected());
-
-                // individual entities can be on indiv. layers
-                tmpPen = ne->getPen(false);
-
-                // color from block (free floating):
-                if (tmpPen.getColor()==RS_Color(RS2::FlagByBlock)) {
-                    tmpPen.setColor(getPen().getColor());
+                continue;
+            }
+            if (rightAngle) {
+                for (RS_Vector const& v: corners) {
+                    RS_Vector const vp = toInsert(v, c, r);
+                    minV = RS_Vector::minimum(minV, vp);
+                    maxV = RS_Vector::maximum(maxV, vp);
                 }
+                continue;
+            }
+            // transform a copy of each entity for exact borders
+			for(auto e: *blk){
+                forInstance(e, blk, c, r, [this](RS_Entity* ne) {
+                    if (ne->getMin().x <= ne->getMax().x) {
+                        minV = RS_Vector::minimum(minV, ne->getMin());
+                        maxV = RS_Vector::maximum(maxV, ne->getMax());
+                    }
+                });
+            }
+        }
+    }
+}
 
-                // line width from block (free floating):
-                if (tmpPen.getWidth()==RS2::WidthByBlock) {
-                    tmpPen.setWidth(getPen().getWidth());
-                }
 
-                // line type from block (free floating):
-                if (tmpPen.getLineType()==RS2::LineByBlock) {
-                    tmpPen.setLineType(getPen().getLineType());
-                }
 
-                // now that we've evaluated all flags, let's strip them:
-                // TODO: strip all flags (width, line type)
-                //tmpPen.setColor(tmpPen.getColor().stripFlags());
+void RS_Insert::calculateBorders() {
+    if (!instanced) {
+        RS_EntityContainer::calculateBorders();
+    }
+}
+
+
 
-                ne->setPen(tmpPen);
+void RS_Insert::updateBorders() {
+    if (instanced) {
+        calculateInstanceBorders();
+    } else {
+        RS_EntityContainer::updateBorders();
+    }
+}
 
-                                ne->setUpdateEnabled(true);
 
-                                if (data.updateMode!=RS2::PreviewUpdate) {
-//                                        RS_DEBUG->print("RS_Insert::update: updating new entity");
-                                        ne->update();
-                                }
 
-//                                RS_DEBUG->print("RS_Insert::update: adding new entity");
-                appendEntity(ne);
-//                std::cout<<"done # of entity: "<<i_en_counts<<std::endl;
+void RS_Insert::forcedCalculateBorders() {
+    if (!instanced) {
+        RS_EntityContainer::forcedCalculateBorders();
+    }
+}
+
+
+
+/**
+ * Draws an instanced insert by drawing transformed copies of the
+ * visible block entities, see forInstance().
+ */
+void RS_Insert::draw(RS_Painter* painter, RS_GraphicView* view,
+                     double& patternOffset) {
+    if (!instanced) {
+        RS_EntityContainer::draw(painter, view, patternOffset);
+        return;
+    }
+	if (!(painter && view)) {
+        return;
+    }
+    RS_Block* blk = getBlockForInsert();
+    if (!blk) {
+        return;
+    }
+
+    if (blk->rtti()==RS2::EntityFontChar) {
+        drawStrokes(painter, view, static_cast<RS_FontChar*>(blk)->getStrokes());
+        return;
+    }
+
+    LC_Rect const viewRect = view->getViewRect(view->getCullingMargin());
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            std::vector<RS_Entity*> visible;
+            if (view->isPrinting()) {
+                visible.assign(blk->begin(), blk->end());
+            } else {
+                // the view in block coordinates
+                RS_Vector const v0 = toBlock(viewRect.minP(), c, r);
+                RS_Vector const v1 = toBlock(viewRect.maxP(), c, r);
+                RS_Vector const v2 = toBlock({viewRect.minP().x, viewRect.maxP().y}, c, r);
+                RS_Vector const v3 = toBlock({viewRect.maxP().x, viewRect.minP().y}, c, r);
+                visible = blk->entitiesInRect({
+                    RS_Vector::minimum(RS_Vector::minimum(v0, v1), RS_Vector::minimum(v2, v3)),
+                    RS_Vector::maximum(RS_Vector::maximum(v0, v1), RS_Vector::maximum(v2, v3))});
+            }
+            for (RS_Entity* e: visible) {
+                forInstance(e, blk, c, r, [painter, view](RS_Entity* ne) {
+                    view->drawEntity(painter, ne);
+                });
             }
         }
     }
-    calculateBorders();
-
-        RS_DEBUG->print("RS_Insert::update: OK");
 }
 
-
+/**
+ * Resolves the block and, for instanced inserts, prepares what is drawn
+ * from it. Blocks of the graphic are prepared by RS_Graphic.
+ */
+void RS_Insert::prepareDrawing(RS_GraphicView* view) {
+    RS_Block* blk = getBlockForInsert();
+    if (instanced && blk) {
+        if (blk->rtti()==RS2::EntityFontChar) {
+            static_cast<RS_FontChar*>(blk)->getStrokes();
+        } else if (data.blockSource) {
+            blk->prepareDrawing(view);
+        }
+    }
+    RS_EntityContainer::prepareDrawing(view);
+}
 
 /**
  * @return Pointer to the block associated with this Insert or
@@ -385,6 +819,301 @@ void RS_Insert::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 }
 
 
+RS_Entity* RS_Insert::firstEntity(RS2::ResolveLevel level) {
+    flatten();
+    return RS_EntityContainer::firstEntity(level);
+}
+
+
+
+RS_Entity* RS_Insert::lastEntity(RS2::ResolveLevel level) {
+    flatten();
+    return RS_EntityContainer::lastEntity(level);
+}
+
+
+
+RS_Entity* RS_Insert::entityAt(int index) {
+    flatten();
+    return RS_EntityContainer::entityAt(index);
+}
+
+
+
+int RS_Insert::findEntity(RS_Entity const* const entity) {
+    flatten();
+    return RS_EntityContainer::findEntity(entity);
+}
+
+
+
+double RS_Insert::getLength() const {
+    if (!instanced) {
+        return RS_EntityContainer::getLength();
+    }
+    RS_Block* blk = getBlockForInsert();
+    if (!blk) {
+        return 0.;
+    }
+    if (usesBlockGeometry()) {
+        return blk->getLength()*fabs(data.scaleFactor.x)*data.cols*data.rows;
+    }
+    double length = 0.;
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            for (auto const& stroke: static_cast<RS_FontChar*>(blk)->getStrokes()) {
+                for (size_t i=1; i<stroke.size(); ++i) {
+                    length += toInsert(stroke[i-1], c, r).distanceTo(toInsert(stroke[i], c, r));
+                }
+            }
+        }
+    }
+    return length;
+}
+
+
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord,
+                                        double* dist) const {
+    if (!instanced) {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    }
+    if (!usesBlockGeometry()) {
+        return getNearestOnStrokes(coord, dist, true);
+    }
+    return getNearestInBlock(coord, dist,
+                             [](RS_Block* blk, const RS_Vector& v, double* d) {
+        return blk->getNearestEndpoint(v, d);
+    });
+}
+
+
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord,
+                                        double* dist, RS_Entity** pEntity) const {
+    if (!instanced) {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist, pEntity);
+    }
+    RS_Vector const point = getNearestEndpoint(coord, dist);
+    if (pEntity && point.valid) {
+        getSubEntities().getDistanceToPoint(point, pEntity);
+    }
+    return point;
+}
+
+
+
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord,
+        bool onEntity, double* dist, RS_Entity** entity) const {
+    if (!instanced) {
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    }
+    RS_Vector const point = usesBlockGeometry()
+            ? getNearestInBlock(coord, dist,
+                                [onEntity](RS_Block* blk, const RS_Vector& v, double* d) {
+        return blk->getNearestPointOnEntity(v, onEntity, d);
+    })
+            : getNearestOnStrokes(coord, dist, false);
+    if (entity && point.valid) {
+        getSubEntities().getDistanceToPoint(point, entity);
+    }
+    return point;
+}
+
+
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord,
+                                      double* dist) const {
+    if (!instanced) {
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    }
+    if (!usesBlockGeometry()) {
+        // scaled letters are only known by their strokes
+        if (dist) {
+            *dist = RS_MAXDOUBLE;
+        }
+        return RS_Vector(false);
+    }
+    return getNearestInBlock(coord, dist,
+                             [](RS_Block* blk, const RS_Vector& v, double* d) {
+        return blk->getNearestCenter(v, d);
+    });
+}
+
+
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord,
+                                      double* dist, int middlePoints) const {
+    if (!instanced) {
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    }
+    if (!usesBlockGeometry()) {
+        // scaled letters are only known by their strokes
+        if (dist) {
+            *dist = RS_MAXDOUBLE;
+        }
+        return RS_Vector(false);
+    }
+    return getNearestInBlock(coord, dist,
+                             [middlePoints](RS_Block* blk, const RS_Vector& v, double* d) {
+        return blk->getNearestMiddle(v, d, middlePoints);
+    });
+}
+
+
+
+RS_Vector RS_Insert::getNearestDist(double distance, const RS_Vector& coord,
+                                    double* dist) const {
+    if (!instanced) {
+        return RS_EntityContainer::getNearestDist(distance, coord, dist);
+    }
+    if (!usesBlockGeometry()) {
+        // scaled letters are only known by their strokes
+        if (dist) {
+            *dist = RS_MAXDOUBLE;
+        }
+        return RS_Vector(false);
+    }
+    double const blockDistance = distance/fabs(data.scaleFactor.x);
+    return getNearestInBlock(coord, dist,
+                             [blockDistance](RS_Block* blk, const RS_Vector& v, double* d) {
+        return blk->getNearestDist(blockDistance, v, d);
+    });
+}
+
+
+
+RS_Vector RS_Insert::getNearestIntersection(const RS_Vector& coord,
+                                            double* dist) {
+    flatten();
+    return RS_EntityContainer::getNearestIntersection(coord, dist);
+}
+
+
+
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord,
+                                     RS_Entity** entity,
+                                     RS2::ResolveLevel level,
+                                     double solidDist) const {
+    if (!instanced) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    RS_Block* blk = getBlockForInsert();
+    if (!blk) {
+        if (entity) {
+            *entity = nullptr;
+        }
+        return RS_MAXDOUBLE;
+    }
+    if (entity && level!=RS2::ResolveNone) {
+        return getSubEntities().getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    if (blk->rtti()==RS2::EntityFontChar) {
+        double minDist = RS_MAXDOUBLE;
+        getNearestOnStrokes(coord, &minDist, false);
+        if (entity) {
+            *entity = const_cast<RS_Insert*>(this);
+        }
+        return minDist;
+    }
+
+    double minDist = RS_MAXDOUBLE;
+    double const factor = fabs(data.scaleFactor.x);
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            double const curDist = factor*blk->getDistanceToPoint(
+                        toBlock(coord, c, r), nullptr, level, solidDist/factor);
+            minDist = std::min(minDist, curDist);
+        }
+    }
+    if (entity) {
+        *entity = (minDist < RS_MAXDOUBLE) ? const_cast<RS_Insert*>(this) : nullptr;
+    }
+    return minDist;
+}
+
+
+
+/**
+ * Draws flattened block geometry, transformed from block to screen
+ * coordinates by a single affine mapping for each column and row.
+ */
+void RS_Insert::drawStrokes(RS_Painter* painter, RS_GraphicView* view,
+                            const std::vector<std::vector<RS_Vector>>& strokes) const {
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            RS_Vector const origin = view->toGui(toInsert(RS_Vector(0., 0.), c, r));
+            RS_Vector const ex = view->toGui(toInsert(RS_Vector(1., 0.), c, r)) - origin;
+            RS_Vector const ey = view->toGui(toInsert(RS_Vector(0., 1.), c, r)) - origin;
+            for (auto const& stroke: strokes) {
+                RS_Vector p0 = origin + ex*stroke.front().x + ey*stroke.front().y;
+                for (size_t i=1; i<stroke.size(); ++i) {
+                    RS_Vector const p1 = origin + ex*stroke[i].x + ey*stroke[i].y;
+                    painter->drawLine(p0, p1);
+                    p0 = p1;
+                }
+            }
+        }
+    }
+}
+
+
+
+/**
+ * Finds the closest point of the flattened letter in all columns and rows.
+ *
+ * @param endpoints only the ends of the strokes are considered
+ */
+RS_Vector RS_Insert::getNearestOnStrokes(const RS_Vector& coord, double* dist,
+                                         bool endpoints) const {
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector closestPoint(false);
+    auto const consider = [&coord, &minDist, &closestPoint](const RS_Vector& p) {
+        double const d = coord.distanceTo(p);
+        if (d < minDist) {
+            minDist = d;
+            closestPoint = p;
+        }
+    };
+    RS_Block* blk = getBlockForInsert();
+    if (!blk) {
+        if (dist) {
+            *dist = minDist;
+        }
+        return closestPoint;
+    }
+    auto const& strokes = static_cast<RS_FontChar*>(blk)->getStrokes();
+    for (int c=0; c<data.cols; ++c) {
+        for (int r=0; r<data.rows; ++r) {
+            for (auto const& stroke: strokes) {
+                RS_Vector p0 = toInsert(stroke.front(), c, r);
+                if (endpoints) {
+                    consider(p0);
+                    consider(toInsert(stroke.back(), c, r));
+                    continue;
+                }
+                for (size_t i=1; i<stroke.size(); ++i) {
+                    RS_Vector const p1 = toInsert(stroke[i], c, r);
+                    RS_Vector const dp = p1 - p0;
+                    double t = 0.;
+                    if (dp.squared() > RS_TOLERANCE*RS_TOLERANCE) {
+                        t = RS_Vector::dotP(coord - p0, dp)/dp.squared();
+                        t = std::max(0., std::min(1., t));
+                    }
+                    consider(p0 + dp*t);
+                    p0 = p1;
+                }
+            }
+        }
+    }
+    if (dist) {
+        *dist = minDist;
+    }
+    return closestPoint;
+}
+
+
+
 std::ostream& operator << (std::ostream& os, const RS_Insert& i) {
     os << " Insert: " << i.getData() << std::endl;
     return os;
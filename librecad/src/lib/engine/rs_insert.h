@@ -28,9 +28,12 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <functional>
+#include <memory>
 #include "rs_entitycontainer.h"
 
 class RS_BlockList;
+class RS_Block;
 
 /**
  * Holds the data that defines an insert.
@@ -87,6 +90,12 @@ std::ostream& operator << (std::ostream& os, const RS_InsertData& d);
  * refer to a block. However, to the outside world they act exactly
  * like EntityContainer.
  *
+ * Instanced inserts don't hold copies of the block entities at all:
+ * they draw transformed copies of the visible block entities on the fly
+ * and answer snapping queries from the block geometry. The copies are
+ * only created by flatten(), e.g. when the entities are iterated with
+ * firstEntity() and nextEntity() or getEntities().
+ *
  * @author Andrew Mustun
  */
 class RS_Insert : public RS_EntityContainer {
@@ -106,6 +115,13 @@ public:
     RS_InsertData getData() const {
         return data;
     }
+    /**
+     * Sets new insert parameters. The entities are not rebuilt, call
+     * update() afterwards.
+     */
+    void setData(const RS_InsertData& d) {
+        data = d;
+    }
 
         /**
          * Reimplementation of reparent. Invalidates block cache pointer.
@@ -119,6 +135,26 @@ public:
 
     virtual void update();
 
+    /**
+     * @return true, if the insert refers to the block geometry instead
+     * of holding transformed copies of the block entities
+     */
+    bool isInstanced() const {
+        return instanced;
+    }
+
+    void flatten();
+
+    /**
+     * @return the entities of this insert, created by flatten() for
+     * instanced inserts. begin() and end() only iterate the entities
+     * which have been created already.
+     */
+    const QList<RS_Entity*>& getEntities() {
+        flatten();
+        return entities;
+    }
+
     QString getName() const {
         return data.name;
     }
@@ -186,11 +222,85 @@ public:
     virtual void scale(const RS_Vector& center, const RS_Vector& factor);
     virtual void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2);
 
+    virtual void calculateBorders();
+    virtual void updateBorders();
+    virtual void forcedCalculateBorders();
+    virtual void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset);
+    virtual void prepareDrawing(RS_GraphicView* view);
+
+    //! \{
+    //! accessing the entities of an instanced insert flattens it
+    virtual RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone);
+    virtual RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone);
+    virtual RS_Entity* entityAt(int index);
+    virtual int findEntity(RS_Entity const* const entity);
+    //! \}
+    virtual double getLength() const;
+
+    virtual RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                         double* dist = nullptr) const;
+    virtual RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                         double* dist, RS_Entity** pEntity) const;
+    virtual RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+            bool onEntity = true, double* dist = nullptr,
+            RS_Entity** entity = nullptr) const;
+    virtual RS_Vector getNearestCenter(const RS_Vector& coord,
+                                       double* dist = nullptr) const;
+    virtual RS_Vector getNearestMiddle(const RS_Vector& coord,
+                                       double* dist = nullptr,
+                                       int middlePoints = 1) const;
+    virtual RS_Vector getNearestDist(double distance,
+                                     const RS_Vector& coord,
+                                     double* dist = nullptr) const;
+    virtual RS_Vector getNearestIntersection(const RS_Vector& coord,
+                                             double* dist = nullptr);
+    virtual double getDistanceToPoint(const RS_Vector& coord,
+                                      RS_Entity** entity,
+                                      RS2::ResolveLevel level=RS2::ResolveNone,
+                                      double solidDist = RS_MAXDOUBLE) const;
+
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
     RS_InsertData data;
 	mutable RS_Block* block;
+
+private:
+    bool canInstance(RS_Block* blk) const;
+    bool isUniform() const;
+    bool usesBlockGeometry() const;
+    void calculateInstanceBorders();
+    RS_Entity* createEntity(RS_Entity* e, RS_Block* blk, int c, int r) const;
+    void transformEntity(RS_Entity* ne, RS_Block* blk, int c, int r) const;
+    const RS_EntityContainer& getSubEntities() const;
+    void forInstance(RS_Entity* e, RS_Block* blk, int c, int r,
+                     std::function<void(RS_Entity*)> const& func,
+                     RS_Entity const* owner = nullptr);
+    RS_Vector toInsert(const RS_Vector& v, int c, int r) const;
+    RS_Vector toBlock(const RS_Vector& v, int c, int r) const;
+    RS_Vector getNearestInBlock(const RS_Vector& coord, double* dist,
+            std::function<RS_Vector(RS_Block*, const RS_Vector&, double*)> const& query) const;
+    void drawStrokes(RS_Painter* painter, RS_GraphicView* view,
+                     const std::vector<std::vector<RS_Vector>>& strokes) const;
+    RS_Vector getNearestOnStrokes(const RS_Vector& coord, double* dist,
+            bool endpoints) const;
+
+    bool instanced = false;
+
+    /**
+     * Transformed block entities of an instanced insert, returned as the
+     * sub-entities found by queries. Copies of the insert start without.
+     */
+    struct SubEntities {
+        SubEntities() = default;
+        SubEntities(const SubEntities&) {}
+        SubEntities& operator = (const SubEntities&) {
+            container.reset();
+            return *this;
+        }
+        std::unique_ptr<RS_EntityContainer> container;
+    };
+    mutable SubEntities subEntities;
 };
 
 
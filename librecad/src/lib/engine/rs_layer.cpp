@@ -24,6 +24,7 @@
 ** This copyright notice MUST APPEAR in all copies of the script!  
 **
 **********************************************************************/
+#include <atomic>
 #include "rs_layer.h"
 
 RS_LayerData::RS_LayerData(const QString& name,
@@ -49,9 +50,18 @@ RS_Layer* RS_Layer::clone() const{
 	return new RS_Layer(*this);
 }
 
+namespace {
+std::atomic<unsigned> renameCount{0};
+}
+
 /** sets a new name for this layer. */
 void RS_Layer::setName(const QString& name) {
 	data.name = name;
+	++renameCount;
+}
+
+unsigned RS_Layer::getRenameCount() {
+	return renameCount;
 }
 
 /** @return the name of this layer. */
@@ -91,6 +91,11 @@ public:
 
     /** sets a new name for this layer. */
 	void setName(const QString& name);
+	/**
+	 * @return number of layer renames so far. Layer lists use it to
+	 * detect renames which didn't go through them.
+	 */
+	static unsigned getRenameCount();
 
     /** @return the name of this layer. */
 	QString getName() const;
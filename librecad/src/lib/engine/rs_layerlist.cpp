@@ -26,6 +26,7 @@
 **********************************************************************/
 
 
+#include <algorithm>
 #include "rs_debug.h"
 #include "rs_layerlist.h"
 #include "rs_layer.h"
@@ -50,6 +51,7 @@ RS_LayerList::RS_LayerList() {
  */
 void RS_LayerList::clear() {
     layers.clear();
+    layerNames.clear();
 	setModified(true);
 }
 
@@ -108,6 +110,21 @@ void RS_LayerList::activate(RS_Layer* layer, bool notify) {
 }
 
 
+/**
+ * Rebuilds the name index from the layers in the list.
+ */
+void RS_LayerList::rebuildNameIndex() {
+    indexedRenames = RS_Layer::getRenameCount();
+    layerNames.clear();
+    layerNames.reserve(layers.size());
+    for (RS_Layer* l: layers) {
+        if (!layerNames.contains(nameKey(l->getName()))) {
+            layerNames.insert(nameKey(l->getName()), l);
+        }
+    }
+}
+
+
 /**
  * @brief sort by layer names
  */
@@ -136,8 +153,13 @@ void RS_LayerList::add(RS_Layer* layer) {
     // check if layer already exists:
     RS_Layer* l = find(layer->getName());
     if (l==NULL) {
-        layers.append(layer);
-        this->sort();
+        // insert at the sorted position, where a stable sort would put it
+        auto it = std::upper_bound(layers.begin(), layers.end(), layer,
+                                   [](const RS_Layer* l0, const RS_Layer* l1)->bool{
+                                       return l0->getName() < l1->getName();
+                                   });
+        layers.insert(it, layer);
+        layerNames.insert(nameKey(layer->getName()), layer);
         // notify listeners
         for (int i=0; i<layerListListeners.size(); ++i) {
             RS_LayerListListener* l = layerListListeners.at(i);
@@ -187,6 +209,9 @@ void RS_LayerList::remove(RS_Layer* layer) {
 #else
     layers.removeOne(layer);
 #endif
+    if (layerNames.value(nameKey(layer->getName()))==layer) {
+        layerNames.remove(nameKey(layer->getName()));
+    }
 
 
     for (int i=0; i<layerListListeners.size(); ++i) {
@@ -217,7 +242,13 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
         return;
     }
 
+    QString const oldName = layer->getName();
     *layer = source;
+    if (layer->getName()!=oldName) {
+        // renamed: the list is sorted by name
+        this->sort();
+        rebuildNameIndex();
+    }
 
     for (int i=0; i<layerListListeners.size(); ++i) {
         RS_LayerListListener* l = layerListListeners.at(i);
@@ -237,14 +268,12 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
 RS_Layer* RS_LayerList::find(const QString& name) {
     //RS_DEBUG->print("RS_LayerList::find begin");
 
-    RS_Layer* ret = NULL;
-
-    for (int i=0; i<layers.size(); ++i) {
-        RS_Layer* l = layers.at(i);
-        if (l->getName()==name) {
-            ret = l;
-            break;
-        }
+    RS_Layer* ret = layerNames.value(nameKey(name), NULL);
+    if (ret ? ret->getName()!=name : indexedRenames!=RS_Layer::getRenameCount()) {
+        // a layer was renamed without edit(): it is still indexed by its
+        // old name
+        rebuildNameIndex();
+        ret = layerNames.value(nameKey(name), NULL);
     }
 
     //RS_DEBUG->print("RS_LayerList::find end");
@@ -259,22 +288,8 @@ RS_Layer* RS_LayerList::find(const QString& name) {
  * was not found.
  */
 int RS_LayerList::getIndex(const QString& name) {
-    //RS_DEBUG->print("RS_LayerList::find begin");
-
-    int ret = -1;
-
-    for (int i=0; i<layers.size(); i++) {
-        RS_Layer* l = layers.at(i);
-
-        if (l->getName()==name) {
-            ret = i;
-            break;
-        }
-    }
-
-    //RS_DEBUG->print("RS_LayerList::find end");
-
-    return ret;
+    RS_Layer* l = find(name);
+    return l ? layers.indexOf(l) : -1;
 }
 
 
@@ -30,6 +30,7 @@
 #define RS_LAYERLIST_H
 
 #include <QList>
+#include <QHash>
 #include "rs_layer.h"
 
 class RS_LayerListListener;
@@ -124,8 +125,21 @@ public:
     friend std::ostream& operator << (std::ostream& os, RS_LayerList& l);
 
 private:
+    /**
+     * @return key of a layer name in the name index. Layer names are
+     * compared case sensitive.
+     */
+    static QString nameKey(const QString& name) {
+        return name;
+    }
+    void rebuildNameIndex();
+
     //! layers in the graphic
     QList<RS_Layer*> layers;
+    //! layers by name, kept in sync by add(), remove(), edit() and clear()
+    QHash<QString, RS_Layer*> layerNames;
+    //! RS_Layer::getRenameCount() when layerNames was built
+    unsigned indexedRenames = 0;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> layerListListeners;
     QG_LayerWidget* layerWidget;
@@ -33,9 +33,7 @@
 #include "rs_painter.h"
 #include "rs_graphic.h"
 #include "rs_linetypepattern.h"
-#include "rs_information.h"
 #include "lc_quadratic.h"
-#include "rs_painterqt.h"
 #include "rs_circle.h"
 #include "lc_rect.h"
 
@@ -541,83 +539,27 @@ void RS_Line::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOff
         return;
     }
 
-    //only draw the visible portion of line
-	LC_Rect const viewportRect{view->toGraph(0, 0),
-				view->toGraph(view->getWidth(), view->getHeight())};
-	RS_VectorSolutions endPoints(0);
-	if (viewportRect.inArea(getStartpoint(), RS_TOLERANCE))
-		 endPoints.push_back(getStartpoint());
-	if (viewportRect.inArea(getEndpoint(), RS_TOLERANCE))
-		 endPoints.push_back(getEndpoint());
-
-	RS_EntityContainer ec(nullptr);
-	ec.addRectangle(viewportRect.minP(), viewportRect.maxP());
-
-	if (endPoints.size()<2){
-		RS_VectorSolutions vpIts;
-		for(auto p: ec) {
-			auto const sol=RS_Information::getIntersection(this, p, true);
-			for (auto const& vp: sol) {
-				if (vpIts.getClosestDistance(vp) <= RS_TOLERANCE * 10.)
-					continue;
-				vpIts.push_back(vp);
-			}
-		}
-		for (auto const& vp: vpIts) {
-			if (endPoints.getClosestDistance(vp) <= RS_TOLERANCE * 10.)
-				continue;
-			endPoints.push_back(vp);
-		}
-	}
-
-	if (endPoints.size()<2) return;
-
-	if ((endPoints[0] - getStartpoint()).squared() >
-			(endPoints[1] - getStartpoint()).squared() )
-		std::swap(endPoints[0],endPoints[1]);
+    //only draw the visible portion of line, clipped in view coordinates
+	// with a margin of one pixel to keep line caps at the view border
+	LC_Rect const viewportRect{RS_Vector{-1., -1.},
+				RS_Vector{view->getWidth() + 1., view->getHeight() + 1.}};
+	RS_Vector const guiStart{view->toGui(getStartpoint())};
+	RS_Vector pStart{guiStart};
+	RS_Vector pEnd{view->toGui(getEndpoint())};
+	// the pattern is continued after the line, visible or not
+	patternOffset -= (pEnd - pStart).magnitude();
+	if (!viewportRect.clip(pStart, pEnd))
+		return;
 
-	RS_Vector pStart{view->toGui(endPoints.at(0))};
-	RS_Vector pEnd{view->toGui(endPoints.at(1))};
-    //    std::cout<<"draw line: "<<pStart<<" to "<<pEnd<<std::endl;
 	RS_Vector direction = pEnd-pStart;
 
 	if (isConstruction(true) && direction.squared() > RS_TOLERANCE){
         //extend line on a construction layer to fill the whole view
-		RS_VectorSolutions vpIts;
-		for(auto p: ec) {
-			auto const sol=RS_Information::getIntersection(this, p, false);
-			for (auto const& vp: sol) {
-				if (vpIts.getClosestDistance(vp) <= RS_TOLERANCE * 10.)
-					continue;
-				vpIts.push_back(vp);
-			}
-		}
-
-		//draw construction lines up to viewport border
-		switch (vpIts.size()) {
-		case 2:
-			// no need to sort intersections
-			break;
-		case 3:
-		case 4: {
-			// will use the inner two points
-			size_t i{0};
-			for (size_t j = 2; j < vpIts.size(); ++j) {
-				if (viewportRect.inArea(vpIts.at(j), RS_TOLERANCE * 10.))
-					std::swap(vpIts[j], vpIts[i++]);
-			}
-		}
-			break;
-		default:
-			//should not happen
+		if (!viewportRect.clipInfinite(pStart, pEnd))
 			return;
-		}
-		pStart=view->toGui(vpIts.get(0));
-		pEnd=view->toGui(vpIts.get(1));
 		direction=pEnd-pStart;
     }
     double  length=direction.magnitude();
-    patternOffset -= length;
     if (( !isSelected() && (
               getPen().getLineType()==RS2::SolidLine ||
               view->getDrawingMode()==RS2::ModePreview)) ) {
@@ -655,41 +597,26 @@ void RS_Line::draw(RS_Painter* painter, RS_GraphicView* view, double& patternOff
     pen.setLineType(RS2::SolidLine);
     painter->setPen(pen);
 
-    // index counter
-	size_t i;
-
-    // pattern segment length:
-    double patternSegmentLength = pat->totalLength;
-
-    // create pattern:
-	size_t const patnum=pat->num > 0?pat->num:0;
-	std::vector<RS_Vector> dp(patnum);
-	std::vector<double> ds(patnum, 0.);
-    if (pat->num >0 ){
-        double dpmm=static_cast<RS_PainterQt*>(painter)->getDpmm();
-        for (i=0; i<pat->num; ++i) {
-            //        ds[j]=pat->pattern[i] * styleFactor;
-            //fixme, styleFactor support needed
-
-            ds[i]=dpmm*pat->pattern[i];
-			if (fabs(ds[i]) < 1. ) ds[i] = (ds[i]>=0.)?1.:-1.;
-            dp[i] = direction*fabs(ds[i]);
-        }
-	} else {
-        RS_DEBUG->print(RS_Debug::D_WARNING,"invalid line pattern for line, draw solid line instread");
-        painter->drawLine(view->toGui(getStartpoint()),
-                          view->toGui(getEndpoint()));
+    // pattern in pixels, shared by all lines of the view:
+    RS_DashPattern const& dashPattern = view->getDashPattern(pat, painter);
+    std::vector<double> const& ds = dashPattern.dashes;
+    double const patternSegmentLength = dashPattern.length;
+    if (ds.empty()) {
+        painter->drawLine(pStart,pEnd);
         return;
     }
-    double total= remainder(patternOffset-0.5*patternSegmentLength,patternSegmentLength) -0.5*patternSegmentLength;
+    // the pattern starts at the line start point, not at the view border,
+    // so dashes match in views or tiles clipping the line differently
+    double const clipped = RS_Vector::dotP(pStart - guiStart, direction);
+    double total= remainder(patternOffset-clipped-0.5*patternSegmentLength,patternSegmentLength) -0.5*patternSegmentLength;
     //    double total= patternOffset-patternSegmentLength;
 
 	RS_Vector curP{pStart+direction*total};
-	for (int j=0; total<length; j=(j+1)%i) {
+	for (size_t j=0; total<length; j=(j+1)%ds.size()) {
 
         // line segment (otherwise space segment)
 		double const t2=total+fabs(ds[j]);
-		RS_Vector const& p3=curP+dp[j];
+		RS_Vector const p3=curP+direction*fabs(ds[j]);
         if (ds[j]>0.0 && t2 > 0.0) {
             // drop the whole pattern segment line, for ds[i]<0:
             // trim end points of pattern segment line to line
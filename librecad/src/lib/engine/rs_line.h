@@ -72,6 +72,10 @@ public:
     RS_LineData getData() const {
         return data;
     }
+    /** Sets new line parameters. */
+    void setData(const RS_LineData& d) {
+        data = d;
+    }
 
 	virtual RS_VectorSolutions getRefPoints() const;
 
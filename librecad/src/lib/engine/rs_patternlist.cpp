@@ -25,6 +25,8 @@
 **********************************************************************/
 
 
+#include <QMutex>
+#include <QMutexLocker>
 #include "rs_patternlist.h"
 
 #include "rs_system.h"
@@ -124,7 +126,10 @@ RS_Pattern* RS_PatternList::requestPattern(const QString& name) {
         RS_Pattern* p = patterns.at(i);
 
         if (p->getFileName()==name2) {
-            // Make sure this pattern is loaded into memory:
+            // Make sure this pattern is loaded into memory, patterns are
+            // shared by documents loaded in worker threads:
+            static QMutex mutex;
+            QMutexLocker lock(&mutex);
             p->loadPattern();
             foundPattern = p;
             break;
@@ -70,6 +70,11 @@ RS_PointData RS_Point::getData() const
     return data;
 }
 
+void RS_Point::setData(const RS_PointData& d)
+{
+    data = d;
+}
+
 RS_Vector RS_Point::getPos() const
 {
     return data.pos;
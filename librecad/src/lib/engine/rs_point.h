@@ -74,6 +74,8 @@ public:
 
     /** @return Copy of data that defines the point. */
     RS_PointData getData() const;
+    /** Sets new point parameters. */
+    void setData(const RS_PointData& d);
 
 	virtual RS_VectorSolutions getRefPoints() const;
 
@@ -694,22 +694,11 @@ void RS_Polyline::draw(RS_Painter* painter,RS_GraphicView* view, double& /*patte
 
 	if (!view) return;
 
-    // draw first entity and set correct pen:
-    RS_Entity* e = firstEntity(RS2::ResolveNone);
-    // We get the pen from the entitycontainer and apply it to the
-    // first line so that subsequent line are draw in the right color
-    //prevent segfault if polyline is empty
-	if (e) {
-        RS_Pen p=this->getPen(true);
-        e->setPen(p);
-        double patternOffset=0.;
-        view->drawEntity(painter, e, patternOffset);
-
-        e = nextEntity(RS2::ResolveNone);
-		while(e) {
-            view->drawEntityPlain(painter, e, patternOffset);
-            e = nextEntity(RS2::ResolveNone);
-        }
+    // the pen of the polyline is set by RS_GraphicView::drawEntity(),
+    // the segments are drawn with it and the pattern continues
+    double patternOffset=0.;
+	for (RS_Entity* e: entities) {
+        view->drawEntityPlain(painter, e, patternOffset);
     }
 }
 
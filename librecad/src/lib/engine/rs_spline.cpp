@@ -25,6 +25,8 @@
 **********************************************************************/
 
 
+#include <algorithm>
+#include <cmath>
 #include "rs_spline.h"
 
 
@@ -33,6 +35,101 @@
 #include "rs_graphicview.h"
 #include "rs_painter.h"
 #include "rs_graphic.h"
+#include "rs_information.h"
+#include "lc_rect.h"
+
+namespace {
+//! chordal error allowed when drawing, in pixels
+constexpr double viewTolerance = 0.5;
+//! samples per knot span before the adaptive subdivision
+constexpr unsigned spanSamples = 4;
+//! a sample interval is divided in at most 2^maxDepth segments
+constexpr int maxDepth = 10;
+//! tessellations kept for drawing at different zoom factors
+constexpr size_t maxViewLevels = 4;
+
+/**
+ * Evaluates single points of a spline, using the knot vectors and
+ * parameter ranges of RS_Spline::rbspline() and RS_Spline::rbsplinu().
+ */
+class SplineEvaluator {
+public:
+	SplineEvaluator(const RS_SplineData& data):
+		controlPoints(data.controlPoints)
+	  ,k(data.degree+1)
+	{
+		if (data.closed) {
+			for (size_t i=0; i<data.degree; ++i) {
+				controlPoints.push_back(data.controlPoints.at(i));
+			}
+		}
+		npts = controlPoints.size();
+		x.resize(npts+k+1, 0);
+		h.resize(npts+2, 1.);
+		nbasis.resize(npts+1, 0.);
+		if (data.closed) {
+			RS_Spline::knotu(npts, k, x);
+			tMin = k-1;
+			tMax = npts;
+		} else {
+			RS_Spline::knot(npts, k, x);
+			tMin = 0.;
+			tMax = x[npts+k];
+		}
+	}
+
+	RS_Vector evaluate(double t) const {
+		RS_Spline::rbasis(k, t, npts, x, h, nbasis);
+		RS_Vector ret(0., 0.);
+		for (int i=1; i<=npts; ++i) {
+			ret += controlPoints[i-1]*nbasis[i];
+		}
+		return ret;
+	}
+
+	unsigned spans() const {
+		return static_cast<unsigned>(tMax - tMin + 0.5);
+	}
+
+	double tMin;
+	double tMax;
+
+private:
+	std::vector<RS_Vector> controlPoints;
+	int npts;
+	int k;
+	std::vector<int> x;
+	std::vector<double> h;
+	mutable std::vector<double> nbasis;
+};
+
+RS_Vector nearestOnSegment(const RS_Vector& coord, const RS_Vector& p0, const RS_Vector& p1) {
+	RS_Vector const dp = p1 - p0;
+	double const l2 = dp.squared();
+	if (l2 < RS_TOLERANCE2) {
+		return p0;
+	}
+	double const t = RS_Vector::dotP(coord - p0, dp)/l2;
+	return p0 + dp*std::max(0., std::min(1., t));
+}
+
+/**
+ * Appends points of the spline between t0 and t1 (excluding t0) to
+ * points, halving the interval until the chordal error is within tolerance.
+ */
+void subdivide(const SplineEvaluator& spline, double t0, const RS_Vector& p0,
+			   double t1, const RS_Vector& p1, double tolerance, int depth,
+			   std::vector<RS_Vector>& points) {
+	double const tm = 0.5*(t0 + t1);
+	RS_Vector const pm = spline.evaluate(tm);
+	if (depth < maxDepth && pm.distanceTo(nearestOnSegment(pm, p0, p1)) > tolerance) {
+		subdivide(spline, t0, p0, tm, pm, tolerance, depth+1, points);
+		subdivide(spline, tm, pm, t1, p1, tolerance, depth+1, points);
+	} else {
+		points.push_back(p1);
+	}
+}
+}
 
 
 RS_SplineData::RS_SplineData(int _degree, bool _closed):
@@ -68,20 +165,20 @@ RS_Entity* RS_Spline::clone() const{
 
 
 void RS_Spline::calculateBorders() {
-    /*minV = RS_Vector::minimum(data.startpoint, data.endpoint);
-    maxV = RS_Vector::maximum(data.startpoint, data.endpoint);
+    resetBorders();
+	for (RS_Vector const& vp: points) {
+        minV = RS_Vector::minimum(vp, minV);
+        maxV = RS_Vector::maximum(vp, maxV);
+    }
+}
 
-    QList<RS_Vector>::iterator it;
-    for (it = data.controlPoints.begin();
-    it!=data.controlPoints.end(); ++it) {
 
-    minV = RS_Vector::minimum(*it, minV);
-    maxV = RS_Vector::maximum(*it, maxV);
-}
-    */
+void RS_Spline::updateBorders() {
+    calculateBorders();
 }
 
 
+
 void RS_Spline::setDegree(size_t deg) {
 	if (deg>=1 && deg<=3) {
 		data.degree = deg;
@@ -143,6 +240,8 @@ void RS_Spline::update() {
     RS_DEBUG->print("RS_Spline::update");
 
     clear();
+    points.clear();
+    viewPoints.clear();
 
     if (isUndone()) {
         return;
@@ -194,29 +293,86 @@ void RS_Spline::update() {
         rbspline(npts,k,p1,b,h,p);
     }
 
-    RS_Vector prev(false);
+	points.reserve(p1);
 	for (i = 1; i <= 3*p1; i += 3) {
-        if (prev.valid) {
-			RS_Line* line = new RS_Line{this, prev, {p[i], p[i+1]}};
-			line->setLayer(nullptr);
-			line->setPen(RS2::FlagInvalid);
-            addEntity(line);
-        }
-        prev = RS_Vector(p[i], p[i+1]);
+		points.emplace_back(p[i], p[i+1]);
+	}
+	calculateBorders();
+}
+
 
-        minV = RS_Vector::minimum(prev, minV);
-        maxV = RS_Vector::maximum(prev, maxV);
+
+/**
+ * Creates the lines of the tessellation as entities of this spline.
+ * The lines are kept until the next update().
+ */
+void RS_Spline::createLines() {
+	if (!entities.isEmpty() || points.size() < 2) {
+		return;
+	}
+	for (size_t i = 1; i < points.size(); ++i) {
+		RS_Line* line = new RS_Line{this, points[i-1], points[i]};
+		line->setLayer(nullptr);
+		line->setPen(RS2::FlagInvalid);
+		line->setSelected(isSelected());
+		addEntity(line);
+	}
+}
+
+
+
+/**
+ * Tessellates the spline for drawing, so that the chordal error is
+ * below the given tolerance. The tolerance is rounded down to a power
+ * of two, tessellations are kept for the last few of them.
+ */
+void RS_Spline::tessellateView(double tolerance) {
+	int const level = std::ilogb(tolerance);
+	if (viewPoints.count(level)) {
+		return;
+	}
+	if (viewPoints.size() >= maxViewLevels) {
+		// drop the tessellation farthest from the new one
+		auto const first = viewPoints.begin();
+		auto const last = std::prev(viewPoints.end());
+		viewPoints.erase(level - first->first > last->first - level ? first : last);
+	}
+	tessellate(level, viewPoints[level]);
+}
+
+/**
+ * Tessellates the spline with a chordal error below 2^level.
+ */
+void RS_Spline::tessellate(int level, std::vector<RS_Vector>& vp) const {
+	vp.clear();
+	if (points.size() < 2) {
+		return;
+	}
+
+	SplineEvaluator const spline(data);
+	double const tol = std::ldexp(1., level);
+	unsigned const samples = std::max(1u, spline.spans()*spanSamples);
+	double t0 = spline.tMin;
+	RS_Vector p0 = spline.evaluate(t0);
+	vp.push_back(p0);
+	for (unsigned i = 1; i <= samples; ++i) {
+		double const t1 = (i == samples) ? spline.tMax :
+			spline.tMin + (spline.tMax - spline.tMin)*i/samples;
+		RS_Vector const p1 = spline.evaluate(t1);
+		subdivide(spline, t0, p0, t1, p1, tol, 0, vp);
+		t0 = t1;
+		p0 = p1;
 	}
 }
 
 RS_Vector RS_Spline::getStartpoint() const {
-   if (data.closed) return RS_Vector(false);
-   return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->firstEntity())->getStartpoint();
+   if (data.closed || points.empty()) return RS_Vector(false);
+   return points.front();
 }
 
 RS_Vector RS_Spline::getEndpoint() const {
-   if (data.closed) return RS_Vector(false);
-   return static_cast<RS_Line*>(const_cast<RS_Spline*>(this)->lastEntity())->getEndpoint();
+   if (data.closed || points.empty()) return RS_Vector(false);
+   return points.back();
 }
 
 
@@ -253,13 +409,53 @@ RS_Vector RS_Spline::getNearestEndpoint(const RS_Vector& coord,
 
 
 
-/*
-// The default implementation of RS_EntityContainer is inaccurate but
-//   has to do for now..
 RS_Vector RS_Spline::getNearestPointOnEntity(const RS_Vector& coord,
-        bool onEntity, double* dist, RS_Entity** entity) {
+        bool /*onEntity*/, double* dist, RS_Entity** entity) const {
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector ret(false);
+	for (size_t i = 1; i < points.size(); ++i) {
+		RS_Vector const vp = nearestOnSegment(coord, points[i-1], points[i]);
+		double const d = coord.squaredTo(vp);
+		if (d < minDist) {
+			minDist = d;
+			ret = vp;
+		}
+	}
+	if (dist) {
+        *dist = ret.valid ? sqrt(minDist) : RS_MAXDOUBLE;
+    }
+	if (entity) {
+		*entity = const_cast<RS_Spline*>(this);
+	}
+    return ret;
+}
+
+
+
+double RS_Spline::getDistanceToPoint(const RS_Vector& coord,
+                                     RS_Entity** entity,
+                                     RS2::ResolveLevel level,
+                                     double solidDist) const {
+	// the line segments only exist after createLines(), the spline is
+	// returned itself on all levels before
+	if ((level == RS2::ResolveAll || level == RS2::ResolveAllButTextImage)
+			&& !entities.isEmpty()) {
+		return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+	}
+	double dist = RS_MAXDOUBLE;
+	getNearestPointOnEntity(coord, true, &dist, entity);
+	return dist;
+}
+
+
+
+double RS_Spline::getLength() const {
+	double ret = 0.;
+	for (size_t i = 1; i < points.size(); ++i) {
+		ret += points[i-1].distanceTo(points[i]);
+	}
+	return ret;
 }
-*/
 
 
 
@@ -304,6 +500,15 @@ void RS_Spline::move(const RS_Vector& offset) {
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.move(offset);
     }
+	// splines are affine invariant, the tessellations are moved as well
+	for (RS_Vector& vp: points) {
+		vp.move(offset);
+	}
+	for (auto& tessellation: viewPoints) {
+		for (RS_Vector& vp: tessellation.second) {
+			vp.move(offset);
+		}
+	}
 //    update();
 }
 
@@ -316,10 +521,18 @@ void RS_Spline::rotate(const RS_Vector& center, const double& angle) {
 
 
 void RS_Spline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
-	RS_EntityContainer::rotate(center, angleVector);
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.rotate(center, angleVector);
 	}
+	for (RS_Vector& vp: points) {
+		vp.rotate(center, angleVector);
+	}
+	for (auto& tessellation: viewPoints) {
+		for (RS_Vector& vp: tessellation.second) {
+			vp.rotate(center, angleVector);
+		}
+	}
+	RS_EntityContainer::rotate(center, angleVector);
 //    update();
 }
 
@@ -337,6 +550,15 @@ void RS_Spline::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 	for (RS_Vector& vp: data.controlPoints) {
 		vp.mirror(axisPoint1, axisPoint2);
 	}
+	for (RS_Vector& vp: points) {
+		vp.mirror(axisPoint1, axisPoint2);
+	}
+	for (auto& tessellation: viewPoints) {
+		for (RS_Vector& vp: tessellation.second) {
+			vp.mirror(axisPoint1, axisPoint2);
+		}
+	}
+	RS_EntityContainer::mirror(axisPoint1, axisPoint2);
 
 //    update();
 }
@@ -355,6 +577,11 @@ void RS_Spline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 
 void RS_Spline::revertDirection() {
 	std::reverse(data.controlPoints.begin(), data.controlPoints.end());
+	std::reverse(points.begin(), points.end());
+	for (auto& tessellation: viewPoints) {
+		std::reverse(tessellation.second.begin(), tessellation.second.end());
+	}
+	RS_EntityContainer::revertDirection();
 }
 
 
@@ -366,22 +593,67 @@ void RS_Spline::draw(RS_Painter* painter, RS_GraphicView* view, double& /*patter
         return;
     }
 
+    // the tessellation is drawn instead of the entities, so selection is
+    // checked here, see RS_GraphicView::drawEntityPlain()
+	if (isSelected() != painter->shouldDrawSelected()) {
+        return;
+    }
 
-    RS_Entity* e=firstEntity(RS2::ResolveNone);
-	if (e) {
-        RS_Pen p=this->getPen(true);
-        e->setPen(p);
-        double patternOffset(0.0);
-        view->drawEntity(painter, e, patternOffset);
-        //RS_DEBUG->print("offset: %f\nlength was: %f", offset, e->getLength());
-
-        e = nextEntity(RS2::ResolveNone);
-		while(e) {
-            view->drawEntityPlain(painter, e, patternOffset);
-            e = nextEntity(RS2::ResolveNone);
-            //RS_DEBUG->print("offset: %f\nlength was: %f", offset, e->getLength());
-        }
+	double const factor = view->getFactor().x;
+	if (!(factor > 0. && std::isfinite(factor))) {
+        return;
+    }
+	// the cached tessellations are only updated by prepareDrawing(), the
+	// spline may be drawn in several threads. Draft tiles of other zoom
+	// factors use the coarsest one that is fine enough, or else the finest
+	// one. Only prints and views without them are tessellated here.
+	int const level = std::ilogb(viewTolerance/factor);
+	std::vector<RS_Vector> tessellation;
+	std::vector<RS_Vector> const* drawn = &tessellation;
+	if (view->isPrinting() || viewPoints.empty()) {
+		tessellate(level, tessellation);
+	} else {
+		auto it = viewPoints.upper_bound(level);
+		if (it != viewPoints.begin()) {
+			--it;
+		}
+		drawn = &it->second;
+	}
+	if (drawn->size() < 2) {
+        return;
     }
+
+    RS_Pen const pen = getPen(true);
+	if (!isSelected() && (pen.getLineType() == RS2::SolidLine
+						  || view->getDrawingMode() == RS2::ModePreview)) {
+		RS_Vector prev = view->toGui(drawn->front());
+		for (size_t i = 1; i < drawn->size(); ++i) {
+			RS_Vector const vp = view->toGui((*drawn)[i]);
+			painter->drawLine(prev, vp);
+			prev = vp;
+		}
+		return;
+	}
+
+	// patterns continue from one segment to the next
+	RS_Line line{nullptr, (*drawn)[0], (*drawn)[1]};
+	line.setLayer(nullptr);
+	line.setPen(pen);
+	line.setSelected(isSelected());
+	double patternOffset(0.0);
+	for (size_t i = 1; i < drawn->size(); ++i) {
+		line.setStartpoint((*drawn)[i-1]);
+		line.setEndpoint((*drawn)[i]);
+		line.draw(painter, view, patternOffset);
+	}
+}
+
+
+void RS_Spline::prepareDrawing(RS_GraphicView* view) {
+	double const factor = view ? view->getFactor().x : 0.;
+	if (factor > 0. && std::isfinite(factor)) {
+		tessellateView(viewTolerance/factor);
+	}
 }
 
 
@@ -456,6 +728,61 @@ void RS_Spline::draw(RS_Painter* painter, RS_GraphicView* view) {
 
 
 
+RS_VectorSolutions RS_Spline::getIntersection(RS_Entity const* e1, RS_Entity const* e2) {
+	RS_VectorSolutions ret;
+
+	if (e1->rtti() != RS2::EntitySpline) std::swap(e1, e2);
+	if (e1->rtti() != RS2::EntitySpline) return ret;
+
+	RS_Spline const* spline = static_cast<RS_Spline const*>(e1);
+	LC_Rect const rect2{e2->getMin(), e2->getMax()};
+	bool const bounded = !e2->isConstruction();
+	std::vector<RS_Vector> const& pts = spline->points;
+	for (size_t i = 1; i < pts.size(); ++i) {
+		if (bounded && !LC_Rect{pts[i-1], pts[i]}.intersects(rect2, RS_TOLERANCE)) {
+			continue;
+		}
+		RS_Line const line{nullptr, pts[i-1], pts[i]};
+		for (RS_Vector const& vp: RS_Information::getIntersection(&line, e2, true)) {
+			// segments share their end points
+			if (ret.getClosestDistance(vp) > RS_TOLERANCE) {
+				ret.push_back(vp);
+			}
+		}
+	}
+	return ret;
+}
+
+
+
+RS_Entity* RS_Spline::firstEntity(RS2::ResolveLevel level) {
+	createLines();
+	return RS_EntityContainer::firstEntity(level);
+}
+
+
+
+RS_Entity* RS_Spline::lastEntity(RS2::ResolveLevel level) {
+	createLines();
+	return RS_EntityContainer::lastEntity(level);
+}
+
+
+
+RS_Entity* RS_Spline::entityAt(int index) {
+	createLines();
+	return RS_EntityContainer::entityAt(index);
+}
+
+
+
+int RS_Spline::findEntity(RS_Entity const* const entity) {
+	createLines();
+	return RS_EntityContainer::findEntity(entity);
+}
+
+
+
 /**
  * @return The reference points of the spline.
  */
@@ -28,6 +28,7 @@
 #ifndef RS_SPLINE_H
 #define RS_SPLINE_H
 
+#include <map>
 #include <vector>
 #include "rs_entitycontainer.h"
 
@@ -56,6 +57,12 @@ std::ostream& operator << (std::ostream& os, const RS_SplineData& ld);
 /**
  * Class for a spline entity.
  *
+ * The spline keeps its tessellation as a flat point array rather than
+ * as line entities. Lines are only created by createLines(), e.g. when
+ * the entities of the spline are iterated with firstEntity() and
+ * nextEntity() (for hatch contours) or getEntities(). For drawing, the curve
+ * is tessellated adaptively to the zoom factor of the view.
+ *
  * @author Andrew Mustun
  */
 class RS_Spline : public RS_EntityContainer {
@@ -165,8 +172,8 @@ public:
 
     virtual RS_Vector getNearestEndpoint(const RS_Vector& coord,
 										 double* dist = nullptr)const;
-    //virtual RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
-	//        bool onEntity=true, double* dist = nullptr, RS_Entity** entity=nullptr);
+    virtual RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+            bool onEntity=true, double* dist = nullptr, RS_Entity** entity=nullptr) const;
     virtual RS_Vector getNearestCenter(const RS_Vector& coord,
 									   double* dist = nullptr)const;
     virtual RS_Vector getNearestMiddle(const RS_Vector& coord,
@@ -177,10 +184,31 @@ public:
 									 double* dist = nullptr)const;
         //virtual RS_Vector getNearestRef(const RS_Vector& coord,
 		//                                 double* dist = nullptr);
-        /*virtual double getDistanceToPoint(const RS_Vector& coord,
-									  RS_Entity** entity=nullptr,
+        virtual double getDistanceToPoint(const RS_Vector& coord,
+                                      RS_Entity** entity,
                                       RS2::ResolveLevel level=RS2::ResolveNone,
-                                                                          double solidDist = RS_MAXDOUBLE);*/
+                                      double solidDist = RS_MAXDOUBLE) const;
+        virtual double getLength() const;
+
+        //! \{
+        //! accessing the entities of a spline creates its lines
+        virtual RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone);
+        virtual RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone);
+        virtual RS_Entity* entityAt(int index);
+        virtual int findEntity(RS_Entity const* const entity);
+        //! \}
+
+        void createLines();
+
+        /**
+         * @return the lines of the spline, created by createLines().
+         * begin() and end() only iterate the lines which have been
+         * created already.
+         */
+        const QList<RS_Entity*>& getEntities() {
+            createLines();
+            return entities;
+        }
 
         virtual void addControlPoint(const RS_Vector& v);
         virtual void removeLastControlPoint();
@@ -195,11 +223,19 @@ public:
 		virtual void revertDirection();
 
         virtual void draw(RS_Painter* painter, RS_GraphicView* view, double& patternOffset);
+        virtual void prepareDrawing(RS_GraphicView* view);
 		const std::vector<RS_Vector>& getControlPoints() const;
 
         friend std::ostream& operator << (std::ostream& os, const RS_Spline& l);
 
         virtual void calculateBorders();
+        virtual void updateBorders();
+
+        /**
+         * Intersections of a spline with another entity, computed on the
+         * tessellation of the spline.
+         */
+        static RS_VectorSolutions getIntersection(RS_Entity const* e1, RS_Entity const* e2);
 
 		static void rbasis(int c, double t, int npts, const std::vector<int>& x, const std::vector<double>& h, std::vector<double>& r);
 
@@ -213,6 +249,16 @@ public:
 
 protected:
 		RS_SplineData data;
+
+private:
+		void tessellateView(double tolerance);
+		void tessellate(int level, std::vector<RS_Vector>& vp) const;
+
+		//! tessellation with $SPLINESEGS points per control point
+		std::vector<RS_Vector> points;
+		//! adaptive tessellations used for drawing, by the binary exponent
+		//! of their tolerance
+		std::map<int, std::vector<RS_Vector>> viewPoints;
 }
 ;
 
@@ -25,9 +25,11 @@
 **********************************************************************/
 
 
+#include <algorithm>
 #include "qc_applicationwindow.h"
 #include "rs_undocycle.h"
 #include "rs_undo.h"
+#include "lc_undodelta.h"
 
 
 
@@ -88,10 +90,12 @@ void RS_Undo::startUndoCycle() {
 	RS_DEBUG->print("RS_Undo::startUndoCycle");
     // definitely delete Undo Cycles and all Undoables in them
 	//   that cannot be redone now:
+	std::set<RS_Undoable*> toRemove;
 	while (undoList.size()>undoPointer+1) {
 		std::shared_ptr<RS_UndoCycle> l = undoList.back();
 		undoList.pop_back();
 		if(!l) continue;
+		undoMemory -= std::min(undoMemory, l->memoryUsage());
 		//remove the undoable in the current cyle
 		for(auto u: l->undoables){
 			if(!u) continue;
@@ -102,16 +106,109 @@ void RS_Undo::startUndoCycle() {
 			}
 			// Delete the Undoable for good:
 			if (u->isUndone()) {
-				removeUndoable(u);
+				toRemove.insert(u);
 			}
 		}
 	}
+	if (!toRemove.empty()) {
+		for(auto& cycle: undoList){
+			if (cycle)
+				cycle->removeFromDeltas(toRemove);
+		}
+	}
+	removeUndoables(toRemove);
 
 	currentCycle.reset(new RS_UndoCycle());
 }
 
 
 
+/**
+ * Drops the oldest undo cycles until the undo list fits into the
+ * memory budget. Undoables that were deleted by a dropped cycle and
+ * are not referenced by any other cycle are deleted for good.
+ */
+void RS_Undo::evictUndoCycles() {
+	if (memoryLimit==0) return;
+	std::set<RS_Undoable*> candidates;
+	while (undoMemory>memoryLimit && undoPointer>0) {
+		std::shared_ptr<RS_UndoCycle> l = undoList.front();
+		undoList.pop_front();
+		--undoPointer;
+		if (!l) continue;
+		undoMemory -= std::min(undoMemory, l->memoryUsage());
+		for (auto u: l->undoables) {
+			if (u && u->isUndone()) {
+				candidates.insert(u);
+			}
+		}
+	}
+	deleteUnreferenced(candidates);
+}
+
+
+
+/**
+ * Deletes those of the given Undoables that are not in any undo cycle.
+ */
+void RS_Undo::deleteUnreferenced(const std::set<RS_Undoable*>& candidates) {
+	if (candidates.empty()) return;
+	std::set<RS_Undoable*> toRemove;
+	for (auto u: candidates) {
+		bool referenced = false;
+		for (auto const& cycle: undoList) {
+			if (cycle && cycle->undoables.count(u)) {
+				referenced = true;
+				break;
+			}
+		}
+		if (!referenced) {
+			toRemove.insert(u);
+		}
+	}
+	if (toRemove.empty()) return;
+	for (auto& cycle: undoList) {
+		if (cycle)
+			cycle->removeFromDeltas(toRemove);
+	}
+	removeUndoables(toRemove);
+}
+
+
+
+/**
+ * @return Estimated memory in bytes held by the undo list.
+ */
+size_t RS_Undo::memoryUsage() const {
+	return undoMemory;
+}
+
+
+
+void RS_Undo::setMemoryLimit(size_t bytes) {
+	memoryLimit = bytes;
+	evictUndoCycles();
+}
+
+
+
+size_t RS_Undo::getMemoryLimit() const {
+	return memoryLimit;
+}
+
+
+
+/**
+ * Deletes the given Undoables one by one.
+ */
+void RS_Undo::removeUndoables(const std::set<RS_Undoable*>& undoables) {
+	for (RS_Undoable* u: undoables) {
+		removeUndoable(u);
+	}
+}
+
+
+
 /**
  * Adds an undoable to the current undo cycle.
  */
@@ -128,13 +225,37 @@ void RS_Undo::addUndoable(RS_Undoable* u) {
 
 
 
+/**
+ * Adds a change applied in place to the current undo cycle, which
+ * takes ownership of it.
+ */
+void RS_Undo::addDelta(LC_UndoDelta* d) {
+    RS_DEBUG->print("RS_Undo::addDelta");
+
+    if (currentCycle) {
+        currentCycle->addDelta(d);
+    } else {
+        RS_DEBUG->print(RS_Debug::D_WARNING,
+                        "RS_Undo::addDelta(): No undo cycle active.");
+        delete d;
+    }
+}
+
+
+
 /**
  * Ends the current undo cycle.
  */
 void RS_Undo::endUndoCycle() {
+    if (currentCycle) {
+        currentCycle->updateMemoryUsage();
+        undoMemory += currentCycle->memoryUsage();
+    }
     addUndoCycle(currentCycle);
+    evictUndoCycles();
     QC_ApplicationWindow::getAppWindow()->setUndoEnable(true);
     QC_ApplicationWindow::getAppWindow()->setRedoEnable(false);
+    QC_ApplicationWindow::getAppWindow()->setUndoMemoryUsage(undoMemory);
     currentCycle = NULL;
 }
 
@@ -162,6 +283,9 @@ bool RS_Undo::undo() {
 			for(RS_Undoable* p: uc->undoables){
 				p->changeUndoState();
 			}
+			for (auto it = uc->deltas.rbegin(); it != uc->deltas.rend(); ++it) {
+				(*it)->undo();
+			}
              QC_ApplicationWindow::getAppWindow()->setRedoEnable(true);
             return true;
         }
@@ -185,6 +309,9 @@ bool RS_Undo::redo() {
             break;
         }
 		if (uc) {
+			for (auto& d: uc->deltas) {
+				d->redo();
+			}
 			for(RS_Undoable* p: uc->undoables){
 				p->changeUndoState();
 			}
@@ -241,6 +368,7 @@ void RS_Undo::setGUIButtons()
 	if(QC_ApplicationWindow::getAppWindow()){
         QC_ApplicationWindow::getAppWindow()->setRedoEnable(undoList.size()>0  && undoPointer+1< undoList.size());
         QC_ApplicationWindow::getAppWindow()->setUndoEnable(undoList.size()>0 && undoPointer>=0 );
+        QC_ApplicationWindow::getAppWindow()->setUndoMemoryUsage(undoMemory);
     }
 }
 
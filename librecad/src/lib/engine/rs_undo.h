@@ -29,10 +29,12 @@
 #define RS_UNDO_H
 
 #include <memory>
+#include <set>
 #include <QList>
 
 class RS_UndoCycle;
 class RS_Undoable;
+class LC_UndoDelta;
 
 /**
  * Undo / redo functionality. The internal undo list consists of
@@ -57,6 +59,7 @@ public:
 
     virtual void startUndoCycle();
     virtual void addUndoable(RS_Undoable* u);
+    virtual void addDelta(LC_UndoDelta* d);
     virtual void endUndoCycle();
 
     /**
@@ -66,12 +69,31 @@ public:
      */
     virtual void removeUndoable(RS_Undoable* u) = 0;
 
+    /**
+     * Deletes all given Undoables. The default implementation calls
+     * removeUndoable() for each of them, implementing classes can
+     * delete them in one batch.
+     */
+    virtual void removeUndoables(const std::set<RS_Undoable*>& undoables);
+
     /**
 	  *\brief enable/disable redo/undo buttons in main application window
 	  *\author: Dongxu Li
       **/
     virtual void setGUIButtons();
 
+    /**
+     * @return Estimated memory in bytes held by the undo list.
+     */
+    size_t memoryUsage() const;
+    /**
+     * Sets the memory budget of the undo list in bytes, 0 for no limit.
+     * The oldest cycles are dropped when the budget is exceeded, the
+     * last cycle is always kept.
+     */
+    void setMemoryLimit(size_t bytes);
+    size_t getMemoryLimit() const;
+
     friend std::ostream& operator << (std::ostream& os, RS_Undo& a);
 
     static bool test();
@@ -79,6 +101,8 @@ public:
 protected:
 
 	void addUndoCycle(std::shared_ptr<RS_UndoCycle> const& i);
+	void evictUndoCycles();
+	void deleteUnreferenced(const std::set<RS_Undoable*>& candidates);
     //! List of undo list items. every item is something that can be undone.
 	QList<std::shared_ptr<RS_UndoCycle>> undoList;
 
@@ -95,6 +119,10 @@ protected:
      */
 	std::shared_ptr<RS_UndoCycle> currentCycle;
 
+    //! Sum of the memory estimates of the cycles in undoList
+    size_t undoMemory = 0;
+    //! Memory budget in bytes, 0 for no limit
+    size_t memoryLimit = 0;
 };
 
 
@@ -1,4 +1,34 @@
 #include"rs_undocycle.h"
+#include "rs_entitycontainer.h"
+#include "lc_undodelta.h"
+
+namespace {
+//! rough size of an entity with its data, used to weigh undo cycles
+constexpr size_t entityBytes = 512;
+//! rough size of a node in the undoable set
+constexpr size_t nodeBytes = 48;
+
+size_t undoableSize(RS_Undoable* u) {
+	if (u->undoRtti()!=RS2::UndoableEntity) {
+		return 0;
+	}
+	RS_Entity* e = static_cast<RS_Entity*>(u);
+	switch (e->rtti()) {
+	// containers owning their children; inserts and splines create
+	// children on demand, counting them would create them
+	case RS2::EntityContainer:
+	case RS2::EntityPolyline:
+	case RS2::EntityHatch:
+		return entityBytes*(1 + static_cast<RS_EntityContainer*>(e)->count());
+	default:
+		return entityBytes;
+	}
+}
+}
+
+RS_UndoCycle::RS_UndoCycle() = default;
+
+RS_UndoCycle::~RS_UndoCycle() = default;
 
 /**
  * Adds an Undoable to this Undo Cycle. Every Cycle can contain one or
@@ -15,6 +45,32 @@ void RS_UndoCycle::removeUndoable(RS_Undoable* u) {
 	undoables.erase(u);
 }
 
+void RS_UndoCycle::addDelta(LC_UndoDelta* delta) {
+	deltas.emplace_back(delta);
+}
+
+void RS_UndoCycle::removeFromDeltas(const std::set<RS_Undoable*>& undoables) {
+	for (auto& d: deltas) {
+		d->removeEntities(undoables);
+	}
+}
+
+size_t RS_UndoCycle::memoryUsage() const {
+	return memory;
+}
+
+void RS_UndoCycle::updateMemoryUsage() {
+	memory = sizeof(*this) + undoables.size()*nodeBytes;
+	for (RS_Undoable* u: undoables) {
+		if (u && u->isUndone()) {
+			memory += undoableSize(u);
+		}
+	}
+	for (auto const& d: deltas) {
+		memory += d->memoryUsage();
+	}
+}
+
 std::ostream& operator << (std::ostream& os,
 								  RS_UndoCycle& uc) {
 	os << " Undo item: " << "\n";
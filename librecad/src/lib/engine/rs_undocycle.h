@@ -29,16 +29,22 @@
 #define RS_UNDOLISTITEM_H
 
 #include <iostream>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "rs_entity.h"
 #include "rs_undoable.h"
 
+class LC_UndoDelta;
+
 /**
  * An Undo Cycle represents an action that was triggered and can 
  * be undone. It stores all the pointers to the Undoables affected by 
  * the action. Undoables are entities in a container that can be
  * created and deleted.
+ * Changes applied to entities in place are stored as deltas, which
+ * are undone after the undoables were toggled and redone before.
  *
  * Undo Cycles are stored within classes derrived from RS_Undo.
  *
@@ -52,7 +58,8 @@ public:
     /**
      * @param type Type of undo item.
      */
-	RS_UndoCycle(/*RS2::UndoType type*/)=default;
+	RS_UndoCycle(/*RS2::UndoType type*/);
+	~RS_UndoCycle();
 
     /**
      * Adds an Undoable to this Undo Cycle. Every Cycle can contain one or
@@ -65,6 +72,28 @@ public:
      */
 	void removeUndoable(RS_Undoable* u);
 
+    /**
+     * Adds a delta to this Undo Cycle, the cycle takes ownership.
+     */
+	void addDelta(LC_UndoDelta* delta);
+
+    /**
+     * Drops undoables which are about to be deleted from the deltas.
+     */
+	void removeFromDeltas(const std::set<RS_Undoable*>& undoables);
+
+    /**
+     * @return Estimated memory in bytes held by this cycle as measured
+     * by updateMemoryUsage().
+     */
+	size_t memoryUsage() const;
+
+    /**
+     * Estimates the memory held by this cycle: the undone entities
+     * kept for undo, the deltas and the bookkeeping.
+     */
+	void updateMemoryUsage();
+
     friend std::ostream& operator << (std::ostream& os,
 									  RS_UndoCycle& uc);
 
@@ -75,6 +104,9 @@ private:
     //RS2::UndoType type;
     //! List of entity id's that were affected by this action
 	std::set<RS_Undoable*> undoables;
+	//! Changes applied in place, in the order they were made
+	std::vector<std::unique_ptr<LC_UndoDelta>> deltas;
+	size_t memory = 0;
 };
 
 #endif
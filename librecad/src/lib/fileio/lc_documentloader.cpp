@@ -0,0 +1,126 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <QRunnable>
+
+#include "lc_documentloader.h"
+#include "rs_debug.h"
+#include "rs_fileio.h"
+#include "rs_graphic.h"
+
+class LC_DocumentLoader::Job: public QRunnable {
+public:
+	explicit Job(LC_DocumentLoader* loader):
+		loader(loader)
+	{
+	}
+
+	virtual void run() {
+		loader->load();
+	}
+
+private:
+	LC_DocumentLoader* loader;
+};
+
+LC_DocumentLoader::LC_DocumentLoader(const QString& fileName,
+									 RS2::FormatType type, QObject* parent):
+	QObject(parent)
+  , fileName(fileName)
+  , type(type)
+  , graphic(new RS_Graphic())  // reads the settings, on this thread
+{
+	pool.setMaxThreadCount(1);
+	connect(this, SIGNAL(loaded(bool)),
+			this, SLOT(slotLoaded(bool)),
+			Qt::QueuedConnection);
+}
+
+LC_DocumentLoader::~LC_DocumentLoader()
+{
+	cancel();
+	pool.waitForDone();
+}
+
+bool LC_DocumentLoader::canLoad(const QString& fileName, RS2::FormatType type)
+{
+	// DWG files are confirmed and reported in dialogs, fonts are laid
+	// out in the window once loaded
+	if (fileName.endsWith(".dwg", Qt::CaseInsensitive))
+		return false;
+	if (type == RS2::FormatUnknown)
+		type = RS_FileIO::detectFormat(fileName);
+	return type == RS2::FormatDXFRW;
+}
+
+void LC_DocumentLoader::start()
+{
+	pool.start(new Job(this));
+}
+
+void LC_DocumentLoader::cancel()
+{
+	cancelling.store(1);
+}
+
+bool LC_DocumentLoader::isCancelled() const
+{
+	return cancelling.load() != 0;
+}
+
+QString LC_DocumentLoader::getFileName() const
+{
+	return fileName;
+}
+
+RS_Graphic* LC_DocumentLoader::takeGraphic()
+{
+	return graphic.release();
+}
+
+/**
+ * Loads the file in the worker thread.
+ */
+void LC_DocumentLoader::load()
+{
+	RS_DEBUG->print("LC_DocumentLoader::load(%s)", fileName.toLatin1().data());
+	bool const success = graphic->open(fileName, type,
+									   [this](qint64 done, qint64 total) {
+		if (total > 0) {
+			int const p = static_cast<int>(100*done/total);
+			if (p != percent) {
+				percent = p;
+				emit progress(p);
+			}
+		}
+		return !isCancelled();
+	});
+	emit loaded(success && !isCancelled());
+}
+
+void LC_DocumentLoader::slotLoaded(bool success)
+{
+	RS_DEBUG->print("LC_DocumentLoader::slotLoaded(%s): %d",
+					fileName.toLatin1().data(), success);
+	if (!success)
+		graphic.reset();
+	emit finished(success);
+}
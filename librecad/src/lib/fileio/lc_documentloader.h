@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_DOCUMENTLOADER_H
+#define LC_DOCUMENTLOADER_H
+
+#include <memory>
+#include <QAtomicInt>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include "rs.h"
+
+class RS_Graphic;
+
+/**
+ * Opens a file into a new graphic in a worker thread.
+ *
+ * The graphic is created on the thread of the loader and is not seen
+ * by anything else until it is loaded: finished() is emitted on the
+ * thread of the loader, the graphic can be taken over then. Every
+ * loader has its own worker, several files are loaded concurrently.
+ *
+ * Only formats imported without user interaction are loaded this way,
+ * see canLoad().
+ */
+class LC_DocumentLoader: public QObject {
+	Q_OBJECT
+public:
+	LC_DocumentLoader(const QString& fileName, RS2::FormatType type,
+					  QObject* parent = nullptr);
+	/** cancels loading and waits for the worker */
+	~LC_DocumentLoader();
+
+	/**
+	 * @return true if the file can be loaded in a worker thread, i.e.
+	 * it is a DXF file
+	 */
+	static bool canLoad(const QString& fileName, RS2::FormatType type);
+
+	void start();
+	bool isCancelled() const;
+
+	QString getFileName() const;
+	/**
+	 * @return the loaded graphic, owned by the caller, or nullptr if
+	 * loading failed or was cancelled
+	 */
+	RS_Graphic* takeGraphic();
+
+public slots:
+	/**
+	 * Asks the worker to stop, finished() is emitted with false once
+	 * it did.
+	 */
+	void cancel();
+
+signals:
+	/** percentage of the file read so far */
+	void progress(int percent);
+	void finished(bool success);
+	//! emitted by the worker when it is done
+	void loaded(bool success);
+
+private slots:
+	void slotLoaded(bool success);
+
+private:
+	class Job;
+
+	void load();
+
+	QString fileName;
+	RS2::FormatType type;
+	std::unique_ptr<RS_Graphic> graphic;
+	QThreadPool pool;
+	QAtomicInt cancelling;
+	//! last percentage reported, used by the worker only
+	int percent = -1;
+};
+
+#endif // LC_DOCUMENTLOADER_H
@@ -46,9 +46,11 @@
  *        entities. Usually that's an RS_Graphic entity but
  *        it can also be a polyline, text, ...
  * @param file Path and name of the file to import.
+ * @param progress Called while the file is read, see
+ *        RS_FilterInterface::setImportProgress().
  */
 bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
-        RS2::FormatType type) {
+        RS2::FormatType type, const RS_FilterInterface::Progress& progress) {
 
     RS_DEBUG->print("Trying to import file '%s'...", file.toLatin1().data());
 
@@ -72,6 +74,7 @@ bool RS_FileIO::fileImport(RS_Graphic& graphic, const QString& file,
                     return false;
             }
 #endif
+            filter->setImportProgress(progress);
             return filter->fileImport(graphic, file, t);
         }
         RS_DEBUG->print(RS_Debug::D_WARNING,
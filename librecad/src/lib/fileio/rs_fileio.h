@@ -66,7 +66,8 @@ public:
 										RS2::FormatType t) const;
 
     bool fileImport(RS_Graphic& graphic, const QString& file,
-		RS2::FormatType type = RS2::FormatUnknown);
+		RS2::FormatType type = RS2::FormatUnknown,
+		const RS_FilterInterface::Progress& progress = nullptr);
 		
     bool fileExport(RS_Graphic& graphic, const QString& file,
 		RS2::FormatType type = RS2::FormatUnknown);
@@ -24,8 +24,10 @@
 **********************************************************************/
 
 
+#include <QFileInfo>
 #include <QStringList>
 #include <QTextCodec>
+#include <QThread>
 
 #include "rs_filterdxfrw.h"
 
@@ -113,6 +115,8 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
     graphic = &g;
     currentContainer = graphic;
 	dummyContainer = new RS_EntityContainer(nullptr, true);
+    importLayers.clear();
+    importPens.clear();
 
     this->file = file;
     // add some variables that need to be there for DXF drawings:
@@ -144,6 +148,11 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, RS2::FormatT
     } else {
 #endif
         dxfRW dxfR(QFile::encodeName(file));
+        // the entities of large files are parsed by worker threads,
+        // starting them does not pay off for small ones. A few workers
+        // keep up with the entities being built on this thread.
+        if (QFileInfo(file).size() > 8*1024*1024)
+            dxfR.setThreads(qBound(1, QThread::idealThreadCount(), 4));
 
         RS_DEBUG->print("RS_FilterDXFRW::fileImport: reading file");
         bool success = dxfR.read(this, true);
@@ -2988,37 +2997,57 @@ void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
                                        const DRW_Entity* attrib) {
     RS_DEBUG->print("RS_FilterDXF::setEntityAttributes");
 
-    RS_Pen pen;
-    pen.setColor(Qt::black);
-    pen.setLineType(RS2::SolidLine);
-    QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
-
-    // Layer: add layer in case it doesn't exist:
-	if (!graphic->findLayer(layName)) {
-        DRW_Layer lay;
-        lay.name = attrib->layer;
-        addLayer(lay);
+    // Layer: add layer in case it doesn't exist. Entities of a file are
+    // on a few layers, they are resolved once per import.
+    auto layerIt = importLayers.find(attrib->layer);
+    if (layerIt == importLayers.end()) {
+        QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
+        if (!graphic->findLayer(layName)) {
+            DRW_Layer lay;
+            lay.name = attrib->layer;
+            addLayer(lay);
+        }
+        layerIt = importLayers.emplace(attrib->layer, graphic->findLayer(layName)).first;
     }
-    entity->setLayer(layName);
+    entity->setLayer(entity->getGraphic() ? layerIt->second : nullptr);
 
-    // Color:
-    if (attrib->color24 >= 0)
-        pen.setColor(RS_Color(attrib->color24 >> 16,
-                              attrib->color24 >> 8 & 0xFF,
-                              attrib->color24 & 0xFF));
-    else
-    pen.setColor(numberToColor(attrib->color));
+    // Pen: the same for all entities with the same attributes
+    PenKey key{attrib->color24, attrib->color, attrib->lWeight, attrib->lineType};
+    auto penIt = importPens.find(key);
+    if (penIt == importPens.end()) {
+        RS_Pen pen;
+        // Color:
+        if (attrib->color24 >= 0)
+            pen.setColor(RS_Color(attrib->color24 >> 16,
+                                  attrib->color24 >> 8 & 0xFF,
+                                  attrib->color24 & 0xFF));
+        else
+            pen.setColor(numberToColor(attrib->color));
 
-    // Linetype:
-    pen.setLineType(nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) ));
+        // Linetype:
+        pen.setLineType(nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) ));
 
-    // Width:
-    pen.setWidth(numberToWidth(attrib->lWeight));
+        // Width:
+        pen.setWidth(numberToWidth(attrib->lWeight));
+        penIt = importPens.emplace(std::move(key), pen).first;
+    }
 
-    entity->setPen(pen);
+    entity->setPen(penIt->second);
     RS_DEBUG->print("RS_FilterDXF::setEntityAttributes: OK");
 }
 
+bool RS_FilterDXFRW::PenKey::operator==(const PenKey& other) const {
+    return color24 == other.color24 && color == other.color
+            && lWeight == other.lWeight && lineType == other.lineType;
+}
+
+size_t RS_FilterDXFRW::PenKeyHash::operator()(const PenKey& key) const {
+    size_t h = std::hash<std::string>()(key.lineType);
+    h = h*31 + std::hash<int>()(key.color24);
+    h = h*31 + std::hash<int>()(key.color);
+    return h*31 + std::hash<int>()(key.lWeight);
+}
+
 
 
 /**
@@ -3188,6 +3217,17 @@ void RS_FilterDXFRW::addComment(const char*) {
 }
 
 
+/**
+ * Forwards the progress of reading a DXF file to the import progress
+ * callback, if any.
+ *
+ * @return false if the import is cancelled.
+ */
+bool RS_FilterDXFRW::readProgress(unsigned long long done, unsigned long long total) {
+    return !importProgress || importProgress(done, total);
+}
+
+
 /**
  * Converts a line type name (e.g. "CONTINUOUS") into a RS2::LineType
  * object.
@@ -26,10 +26,14 @@
 #ifndef RS_FILTERDXFRW_H
 #define RS_FILTERDXFRW_H
 
+#include <string>
+#include <unordered_map>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
 #include "rs_dimension.h"
+#include "rs_pen.h"
 #include "drw_interface.h"
 #include "libdxfrw.h"
 
@@ -121,6 +125,7 @@ public:
 
     virtual void add3dFace(const DRW_3Dface& data);
     virtual void addComment(const char*);
+    virtual bool readProgress(unsigned long long done, unsigned long long total);
 
     // Export:
     virtual bool fileExport(RS_Graphic& g, const QString& file, RS2::FormatType type);
@@ -190,6 +195,18 @@ public:
     static RS_FilterInterface* createFilter(){return new RS_FilterDXFRW();}
 
 private:
+    /** DXF attributes an imported entity pen is made of. */
+    struct PenKey {
+        int color24;
+        int color;
+        int lWeight;
+        std::string lineType;
+        bool operator==(const PenKey& other) const;
+    };
+    struct PenKeyHash {
+        size_t operator()(const PenKey& key) const;
+    };
+
     void prepareBlocks();
     void writeEntity(RS_Entity* e);
 #ifdef DWGSUPPORT
@@ -228,6 +245,9 @@ private:
     QHash<int, RS_EntityContainer*> blockHash;
     /** Pointer to entity container to store posible horphan entites like paper space */
     RS_EntityContainer* dummyContainer;
+    /** Layers and pens of the imported entities by their DXF attributes. */
+    std::unordered_map<std::string, RS_Layer*> importLayers;
+    std::unordered_map<PenKey, RS_Pen, PenKeyHash> importPens;
 };
 
 #endif
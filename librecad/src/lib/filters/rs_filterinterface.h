@@ -28,6 +28,7 @@
 #ifndef RS_FILTERINTERFACE_H
 #define RS_FILTERINTERFACE_H
 
+#include <functional>
 #include "rs_graphic.h"
 
 /**
@@ -40,6 +41,12 @@
  */
 class RS_FilterInterface {
 public:
+    /**
+     * Receives the bytes read so far and the size of the file while a
+     * file is imported, returns false to cancel the import.
+     */
+    using Progress = std::function<bool(qint64 done, qint64 total)>;
+
     /**
      * Constructor.
      */
@@ -80,7 +87,18 @@ public:
      */
     virtual bool fileExport(RS_Graphic& g, const QString& file, RS2::FormatType type) = 0;
 
+    /**
+     * Sets the callback for the progress of fileImport(). Filters which
+     * do not report progress cannot be cancelled either.
+     */
+    void setImportProgress(const Progress& progress) {
+        importProgress = progress;
+    }
+
     static RS_FilterInterface * createFilter(){return NULL;}
+
+protected:
+    Progress importProgress;
 };
 
 #endif
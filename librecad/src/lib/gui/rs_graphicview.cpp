@@ -30,6 +30,7 @@
 #include <QAction>
 #include <QMouseEvent>
 #include <climits>
+#include <cmath>
 #include "rs_graphicview.h"
 
 #include "rs_line.h"
@@ -94,6 +95,25 @@ void RS_GraphicView::setContainer(RS_EntityContainer* container) {
 
 
 
+void RS_GraphicView::copyDrawingSettings(const RS_GraphicView& view) {
+	container = view.container;
+	background = view.background;
+	foreground = view.foreground;
+	selectedColor = view.selectedColor;
+	highlightedColor = view.highlightedColor;
+	startHandleColor = view.startHandleColor;
+	handleColor = view.handleColor;
+	endHandleColor = view.endHandleColor;
+	drawingMode = view.drawingMode;
+	deleteMode = view.deleteMode;
+	draftMode = view.draftMode;
+	printPreview = view.printPreview;
+	printing = view.printing;
+	factor = view.factor;
+}
+
+
+
 /**
  * Sets the zoom factor in X for this visualization of the graphic.
  */
@@ -494,7 +514,7 @@ void RS_GraphicView::zoomIn(double f, const RS_Vector& center) {
 	//adjustOffsetControls();
 	//adjustZoomControls();
 	// updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -508,7 +528,7 @@ void RS_GraphicView::zoomInX(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	// updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -522,7 +542,7 @@ void RS_GraphicView::zoomInY(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	//    updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -555,7 +575,7 @@ void RS_GraphicView::zoomOutX(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	//    updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -574,7 +594,7 @@ void RS_GraphicView::zoomOutY(double f) {
 	adjustOffsetControls();
 	adjustZoomControls();
 	//    updateGrid();
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 /**
@@ -590,7 +610,10 @@ void RS_GraphicView::zoomAuto(bool axis, bool keepAspectRatio) {
 
 
 	if (container) {
-		container->calculateBorders();
+		// the entities keep their borders up to date, only collect them
+		// again, e.g. for layers frozen since
+		container->invalidateBorders();
+		container->refreshBorders();
 
 		double sx, sy;
 		if (axis) {
@@ -732,7 +755,7 @@ void RS_GraphicView::restoreView() {
 	adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -885,7 +908,7 @@ void RS_GraphicView::zoomWindow(RS_Vector v1, RS_Vector v2,
 	adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -904,7 +927,7 @@ void RS_GraphicView::zoomPan(int dx, int dy) {
 	//adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -931,7 +954,7 @@ void RS_GraphicView::zoomScroll(RS2::Direction direction) {
 	adjustZoomControls();
 	//    updateGrid();
 
-	redraw();
+	redraw(RS2::RedrawView);
 }
 
 
@@ -1206,23 +1229,12 @@ void RS_GraphicView::setPenForEntity(RS_Painter *painter,RS_Entity *e)
  *        lines e.g. in splines).
  * @param db Double buffering on (recommended) / off
  */
-void RS_GraphicView::drawEntity(RS_Entity* /*e*/, double& /*patternOffset*/) {
-	RS_DEBUG->print("RS_GraphicView::drawEntity(RS_Entity*,patternOffset) not supported anymore");
-	// RVT_PORT this needs to be optimized
-	// ONe way to do is to send a RS2::RedrawSelected, then teh draw routine will onyl draw all selected entities
-	// Dis-advantage is that we still need to iterate over all entities, but
-	// this might be very fast
-	// For now we just redraw the drawing untill we are going to optmize drawing
-	redraw(RS2::RedrawDrawing);
+void RS_GraphicView::drawEntity(RS_Entity* e, double& /*patternOffset*/) {
+	// entities are drawn by the paint event, only the area they cover is redrawn
+	redrawEntity(e);
 }
-void RS_GraphicView::drawEntity(RS_Entity* /*e*/ /*patternOffset*/) {
-	RS_DEBUG->print("RS_GraphicView::drawEntity(RS_Entity*,patternOffset) not supported anymore");
-	// RVT_PORT this needs to be optimized
-	// ONe way to do is to send a RS2::RedrawSelected, then teh draw routine will onyl draw all selected entities
-	// Dis-advantage is that we still need to iterate over all entities, but
-	// this might be very fast
-	// For now we just redraw the drawing untill we are going to optmize drawing
-	redraw(RS2::RedrawDrawing);
+void RS_GraphicView::drawEntity(RS_Entity* e) {
+	redrawEntity(e);
 }
 void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e) {
 	double offset(0.);
@@ -1248,13 +1260,9 @@ void RS_GraphicView::drawEntity(RS_Painter *painter, RS_Entity* e, double& patte
 	}
 
 	// test if the entity is in the viewport
-	/* temporary disabled so rs_overlaylien can be drawn
-	if (!e->isContainer() && !isPrinting() &&
-            (painter==nullptr || !painter->isPreviewMode()) &&
-			(toGuiX(e->getMax().x)<0 || toGuiX(e->getMin().x)>getWidth() ||
-			 toGuiY(e->getMin().y)<0 || toGuiY(e->getMax().y)>getHeight())) {
+	if (!drawingOverlay && !isPrinting() && isOutsideViewport(e)) {
 		return;
-	} */
+	}
 
 	// set pen (color):
 	setPenForEntity(painter, e );
@@ -1349,12 +1357,10 @@ void RS_GraphicView::drawEntityPlain(RS_Painter *painter, RS_Entity* e) {
  */
 void RS_GraphicView::deleteEntity(RS_Entity* e) {
 
-	// RVT_PORT When we delete a single entoty, we can do this but we need to remove this then also from containerEntities
-	RS_DEBUG->print("RS_GraphicView::deleteEntity will for now redraw the whole screen instead of just deleting the entity");
+	// the area covered by the entity is redrawn without it
 	setDeleteMode(true);
 	drawEntity(e);
 	setDeleteMode(false);
-	redraw(RS2::RedrawDrawing);
 }
 
 
@@ -1461,6 +1467,26 @@ const RS_LineTypePattern* RS_GraphicView::getPattern(RS2::LineType t) {
 }
 
 
+const RS_DashPattern& RS_GraphicView::getDashPattern(const RS_LineTypePattern* pattern,
+													 RS_Painter* painter) {
+	double const dpmm = painter->getDpmm();
+	if (dpmm != dashPatternsDpmm) {
+		dashPatterns.clear();
+		dashPatternsDpmm = dpmm;
+	}
+	RS_DashPattern& dashPattern = dashPatterns[pattern];
+	if (dashPattern.dashes.empty()) {
+		for (double l: pattern->pattern) {
+			double d = dpmm*l;
+			if (fabs(d) < 1.) d = (d>=0.)?1.:-1.;
+			dashPattern.dashes.push_back(d);
+			dashPattern.length += fabs(d);
+		}
+	}
+	return dashPattern;
+}
+
+
 
 /**
  * This virtual method can be overwritten to draw the absolute
@@ -1596,9 +1622,23 @@ void RS_GraphicView::drawGrid(RS_Painter *painter) {
 	painter->setPen(gridColor);
 
 	//grid->updatePointArray();
-	auto const& pts = grid->getPoints();
-	for(auto const& v: pts){
-		painter->drawGridPoint(toGui(v));
+	auto const& columns = grid->getColumns();
+	auto const& rows = grid->getRows();
+	std::vector<double> x(columns.size());
+	std::vector<double> y(rows.size());
+	for (size_t i=0; i<columns.size(); ++i)
+		x[i] = toGuiX(columns[i]);
+	for (size_t i=0; i<rows.size(); ++i)
+		y[i] = toGuiY(rows[i]);
+	painter->drawGridPoints(x, y);
+	if (grid->isIsometric()) {
+		// the points at the centers of the cells
+		RS_Vector const shift = grid->getCellVector()*0.5;
+		for (size_t i=0; i<columns.size(); ++i)
+			x[i] = toGuiX(columns[i] + shift.x);
+		for (size_t i=0; i<rows.size(); ++i)
+			y[i] = toGuiY(rows[i] + shift.y);
+		painter->drawGridPoints(x, y);
 	}
 
 	// draw grid info:
@@ -1691,6 +1731,7 @@ void RS_GraphicView::drawMetaGrid(RS_Painter *painter) {
 }
 
 void RS_GraphicView::drawOverlay(RS_Painter *painter) {
+	drawingOverlay = true;
 	QList<int> const& keys=overlayEntities.keys();
 	for (int i = 0; i < keys.size(); ++i) {
 		if (overlayEntities[i]) {
@@ -1698,6 +1739,7 @@ void RS_GraphicView::drawOverlay(RS_Painter *painter) {
 			drawEntityPlain(painter, overlayEntities[i]);
 		}
 	}
+	drawingOverlay = false;
 }
 
 RS2::SnapRestriction RS_GraphicView::getSnapRestriction() const
@@ -1794,6 +1836,75 @@ RS_Vector RS_GraphicView::toGraph(int x, int y) const{
 }
 
 
+LC_Rect RS_GraphicView::getViewRect(int margin) const
+{
+	return {toGraph(-margin, getHeight() + margin),
+			toGraph(getWidth() + margin, -margin)};
+}
+
+bool RS_GraphicView::isOutsideViewport(const RS_Entity* e) const
+{
+	switch (e->rtti()) {
+	// infinite or in screen coordinates
+	case RS2::EntityConstructionLine:
+	case RS2::EntityOverlayBox:
+		return false;
+	default:
+		break;
+	}
+	if (e->isDocument()) {
+		return false;
+	}
+
+	RS_Vector const& vMin = e->getMin();
+	RS_Vector const& vMax = e->getMax();
+	// no valid borders, e.g. empty containers
+	if (vMin.x > vMax.x || vMin.y > vMax.y) {
+		return false;
+	}
+
+	double const left = toGuiX(vMin.x);
+	double const right = toGuiX(vMax.x);
+	double const top = toGuiY(vMax.y);
+	double const bottom = toGuiY(vMin.y);
+	if (right >= 0. && left <= getWidth() && bottom >= 0. && top <= getHeight()) {
+		return false;
+	}
+
+	int const margin = getCullingMargin();
+	return right < -margin || left > getWidth() + margin
+			|| bottom < -margin || top > getHeight() + margin;
+}
+
+int RS_GraphicView::getCullingMargin() const
+{
+	double uf = 1.0;
+	RS_Graphic* graphic = container ? container->getGraphic() : nullptr;
+	if (graphic) {
+		uf = RS_Units::convert(1.0, RS2::Millimeter, graphic->getUnit());
+	}
+	// widest pen (RS2::Width23, 2.11mm) and a few pixels for handles
+	return 8 + static_cast<int>(std::ceil(toGuiDX(RS2::Width23 / 100.0 * uf)));
+}
+
+void RS_GraphicView::redrawArea(const LC_Rect& /*area*/)
+{
+	redraw(RS2::RedrawDrawing);
+}
+
+void RS_GraphicView::redrawEntity(RS_Entity* e)
+{
+	if (e && e->rtti() != RS2::EntityConstructionLine) {
+		RS_Vector const& vMin = e->getMin();
+		RS_Vector const& vMax = e->getMax();
+		if (vMin.valid && vMax.valid && vMin.x <= vMax.x && vMin.y <= vMax.y) {
+			redrawArea({vMin, vMax});
+			return;
+		}
+	}
+	redraw(RS2::RedrawDrawing);
+}
+
 /**
  * Translates a screen coordinate in X to a real coordinate X.
  */
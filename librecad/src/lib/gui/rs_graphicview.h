@@ -29,12 +29,14 @@
 #define RS_GRAPHICVIEW_H
 
 #include "rs_entitycontainer.h"
+#include "rs_linetypepattern.h"
 #include "rs_snapper.h"
 
 #include <QDateTime>
 #include <QMap>
 #include <tuple>
 #include <memory>
+#include <unordered_map>
 #include <QAction>
 
 
@@ -44,7 +46,6 @@ class RS_ActionInterface;
 class RS_EventHandler;
 class RS_CommandEvent;
 class RS_Grid;
-struct RS_LineTypePattern;
 
 
 /**
@@ -112,6 +113,9 @@ public:
 	/** This virtual method must be overwritten to redraw
 	  the widget. */
 	virtual void redraw(RS2::RedrawMethod method=RS2::RedrawAll) = 0;
+	/** Redraws the part of the drawing within area, in graph coordinates.
+	  The default implementation redraws the whole drawing. */
+	virtual void redrawArea(const LC_Rect& area);
 	/** This virtual method must be overwritten and is then
 	  called whenever the view changed */
     virtual void adjustOffsetControls() = 0;
@@ -292,6 +296,12 @@ public:
     virtual RS_Vector getMousePosition() const = 0;
 
 	virtual const RS_LineTypePattern* getPattern(RS2::LineType t);
+	/**
+	 * @return pattern scaled to the pixels of painter, computed once
+	 * per pattern and paint device resolution
+	 */
+	const RS_DashPattern& getDashPattern(const RS_LineTypePattern* pattern,
+										 RS_Painter* painter);
 
 	virtual void drawAbsoluteZero(RS_Painter *painter);
 	virtual void drawRelativeZero(RS_Painter *painter);
@@ -326,6 +336,32 @@ public:
 	double toGraphDX(int d) const;
 	double toGraphDY(int d) const;
 
+	/**
+	 * @brief getViewRect the visible area in graph coordinates
+	 * @param margin extra border around the view in pixels
+	 */
+	LC_Rect getViewRect(int margin = 0) const;
+	/**
+	 * @brief isOutsideViewport whether an entity can be skipped for
+	 * drawing, because its borders are out of the visible area
+	 */
+	bool isOutsideViewport(const RS_Entity* e) const;
+	/**
+	 * @brief getCullingMargin pixels drawn around entity borders by wide
+	 * pens and handles of selected entities
+	 */
+	int getCullingMargin() const;
+	/**
+	 * @brief redrawEntity redraws the area covered by an entity, or the
+	 * whole drawing if the entity has no finite borders
+	 */
+	void redrawEntity(RS_Entity* e);
+	/**
+	 * @brief copyDrawingSettings takes over the container, colors, modes
+	 * and zoom factor of another view, to draw the same entities as it
+	 */
+	void copyDrawingSettings(const RS_GraphicView& view);
+
 	/**
 		 * (Un-)Locks the position of the relative zero.
 		 *
@@ -458,9 +494,14 @@ private:
 	bool printPreview=false;
 	//! Active when printing only:
 	bool printing=false;
+	//! overlays are drawn in screen coordinates, never culled
+	bool drawingOverlay=false;
 
 	// Map that will be used for overlaying additional items on top of the main CAD drawing
 	QMap<int, RS_EntityContainer *> overlayEntities;
+	//! scaled line patterns, see getDashPattern()
+	std::unordered_map<const RS_LineTypePattern*, RS_DashPattern> dashPatterns;
+	double dashPatternsDpmm=0.;
 	/** if true, graphicView is under cleanup */
 	bool m_bIsCleanUp=false;
 
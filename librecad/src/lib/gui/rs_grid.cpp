@@ -50,7 +50,22 @@ const double minimumGridWidth=1.0e-8;
 RS_Grid::RS_Grid(RS_GraphicView* graphicView)
     :graphicView(graphicView)
     ,baseGrid(false)
-{}
+{
+	loadSettings();
+}
+
+void RS_Grid::loadSettings() {
+	RS_SETTINGS->beginGroup("/Appearance");
+	scaleGrid = (bool)RS_SETTINGS->readNumEntry("/ScaleGrid", 1);
+	minGridSpacing = RS_SETTINGS->readNumEntry("/MinGridSpacing", 10);
+	// used without a graphic:
+	settingsIsometric = (bool)RS_SETTINGS->readNumEntry("/IsometricGrid", 0);
+	settingsCrosshairType=static_cast<RS2::CrosshairType>(RS_SETTINGS->readNumEntry("/CrosshairType",0));
+	settingsUserGrid.x = RS_SETTINGS->readEntry("/GridSpacingX",QString("-1")).toDouble();
+	settingsUserGrid.y = RS_SETTINGS->readEntry("/GridSpacingY",QString("-1")).toDouble();
+	RS_SETTINGS->endGroup();
+	layoutValid = false;
+}
 
 /**
  * find the closest grid point
@@ -81,9 +96,6 @@ void RS_Grid::updatePointArray() {
 
 	RS_Graphic* graphic = graphicView->getGraphic();
 
-	// auto scale grid?
-	RS_SETTINGS->beginGroup("/Appearance");
-	bool scaleGrid = (bool)RS_SETTINGS->readNumEntry("/ScaleGrid", 1);
 	// get grid setting
 	RS_Vector userGrid;
 	if (graphic) {
@@ -93,17 +105,15 @@ void RS_Grid::updatePointArray() {
 		userGrid = graphic->getVariableVector("$GRIDUNIT",
 											 RS_Vector(-1.0, -1.0));
 	}else {
-		isometric = (bool)RS_SETTINGS->readNumEntry("/IsometricGrid", 0);
-		crosshairType=static_cast<RS2::CrosshairType>(RS_SETTINGS->readNumEntry("/CrosshairType",0));
-		userGrid.x = RS_SETTINGS->readEntry("/GridSpacingX",QString("-1")).toDouble();
-		userGrid.y = RS_SETTINGS->readEntry("/GridSpacingY",QString("-1")).toDouble();
+		isometric = settingsIsometric;
+		crosshairType=settingsCrosshairType;
+		userGrid = settingsUserGrid;
 	}
-	int minGridSpacing = RS_SETTINGS->readNumEntry("/MinGridSpacing", 10);
-	RS_SETTINGS->endGroup();
 
 	// std::cout<<"Grid userGrid="<<userGrid<<std::endl;
 
-	pt.clear();
+	columns.clear();
+	rows.clear();
 	metaX.clear();
 	metaY.clear();
 
@@ -117,22 +127,30 @@ void RS_Grid::updatePointArray() {
 		format = graphic->getLinearFormat();
 	}
 
-	RS_Vector gridWidth;
-	// RS_Vector metaGridWidth;
-
 	// RS_DEBUG->print("RS_Grid::update: 002");
 
-	// init grid spacing:
-	// metric grid:
-	if (RS_Units::isMetric(unit) || unit==RS2::None ||
-			format==RS2::Decimal || format==RS2::Engineering) {
-		//metric grid
-		gridWidth = getMetricGridWidth(userGrid, scaleGrid, minGridSpacing);
-
-	}else {
-		// imperial grid:
-		gridWidth = getImperialGridWidth(userGrid, scaleGrid, minGridSpacing);
+	// the grid width only depends on the zoom and the grid settings
+	RS_Vector const& factor = graphicView->getFactor();
+	if (!(layoutValid && layoutFactor==factor && layoutUserGrid==userGrid &&
+		  layoutUnit==unit && layoutFormat==format && layoutIsometric==isometric)) {
+		// init grid spacing:
+		// metric grid:
+		if (RS_Units::isMetric(unit) || unit==RS2::None ||
+				format==RS2::Decimal || format==RS2::Engineering) {
+			//metric grid
+			gridWidth = getMetricGridWidth(userGrid, scaleGrid, minGridSpacing);
+
+		}else {
+			// imperial grid:
+			gridWidth = getImperialGridWidth(userGrid, scaleGrid, minGridSpacing);
 
+		}
+		layoutValid = true;
+		layoutFactor = factor;
+		layoutUserGrid = userGrid;
+		layoutUnit = unit;
+		layoutFormat = format;
+		layoutIsometric = isometric;
 	}
 
 	// RS_DEBUG->print("RS_Grid::update: 013");
@@ -379,22 +397,16 @@ void RS_Grid::createOrthogonalGrid(LC_Rect const& rect, RS_Vector const& gridWid
 	//todo, fix baseGrid for orthogonal grid
 	baseGrid.set(left,bottom);
 
-	// create grid array:
+	// create grid columns and rows:
 
 	if (number<=0 || number>maxGridPoints) return;
 
-	pt.resize(number);
-
-	int i=0;
-	RS_Vector bp0(baseGrid);
-	for (int y=0; y<numberY; ++y) {
-		RS_Vector bp1(bp0);
-		for (int x=0; x<numberX; ++x) {
-			pt[i++] = bp1;
-			bp1.x += gridWidth.x;
-		}
-		bp0.y += gridWidth.y;
-	}
+	columns.resize(numberX);
+	rows.resize(numberY);
+	for (int x=0; x<numberX; ++x)
+		columns[x] = baseGrid.x + x*gridWidth.x;
+	for (int y=0; y<numberY; ++y)
+		rows[y] = baseGrid.y + y*gridWidth.y;
 	// find meta grid boundaries
 	if (metaGridWidth.x>minimumGridWidth && metaGridWidth.y>minimumGridWidth &&
 			graphicView->toGuiDX(metaGridWidth.x)>2 &&
@@ -444,27 +456,20 @@ void RS_Grid::createIsometricGrid(LC_Rect const& rect, RS_Vector const& gridWidt
 	int numberY = (RS_Math::round((top-bottom) / gridWidth.y) + 1);
 	double dx=sqrt(3.)*gridWidth.y;
 	cellV.set(fabs(dx),fabs(gridWidth.y));
-	double hdx=0.5*dx;
-	double hdy=0.5*gridWidth.y;
 	int numberX = (RS_Math::round((right-left) / dx) + 1);
 	int number = 2*numberX*numberY;
 	baseGrid.set(left+remainder(-left,dx),bottom+remainder(-bottom,fabs(gridWidth.y)));
 
 	if (number<=0 || number>maxGridPoints) return;
 
-	pt.resize(number);
-
-	int i=0;
-	RS_Vector bp0(baseGrid),dbp1(hdx,hdy);
-	for (int y=0; y<numberY; ++y) {
-		RS_Vector bp1(bp0);
-		for (int x=0; x<numberX; ++x) {
-			pt[i++] = bp1;
-			pt[i++] = bp1+dbp1;
-			bp1.x += dx;
-		}
-		bp0.y += gridWidth.y;
-	}
+	// the points at the centers of the cells are shifted by cellV/2,
+	// see RS_GraphicView::drawGrid()
+	columns.resize(numberX);
+	rows.resize(numberY);
+	for (int x=0; x<numberX; ++x)
+		columns[x] = baseGrid.x + x*dx;
+	for (int y=0; y<numberY; ++y)
+		rows[y] = baseGrid.y + y*gridWidth.y;
 	//find metaGrid
 	if (metaGridWidth.y>minimumGridWidth &&
 			graphicView->toGuiDY(metaGridWidth.y)>2) {
@@ -496,8 +501,12 @@ QString RS_Grid::getInfo() const{
 	return QString("%1 / %2").arg(spacing).arg(metaSpacing);
 }
 
-std::vector<RS_Vector> const& RS_Grid::getPoints() const{
-	return pt;
+std::vector<double> const& RS_Grid::getColumns() const{
+	return columns;
+}
+
+std::vector<double> const& RS_Grid::getRows() const{
+	return rows;
 }
 
 std::vector<double> const& RS_Grid::getMetaX() const{
@@ -44,6 +44,10 @@ using LC_Rect = lc::geo::Area;
  * This class represents a grid. Grids can be drawn on graphic
  * views and snappers can snap to the grid points.
  *
+ * The grid width is only determined again when the zoom or the
+ * grid settings change, panning just moves the visible rows and
+ * columns.
+ *
  * @author Andrew Mustun
  */
 class RS_Grid
@@ -52,12 +56,19 @@ class RS_Grid
 public:
 	RS_Grid(RS_GraphicView* graphicView);
 
+	/** reads the grid settings of the application again */
+	void loadSettings();
 	void updatePointArray();
 
 	/**
-		 * @return Array of all visible grid points.
+		 * @return x coordinates of the visible grid points, there is
+		 * a point at every column and row.
+		 */
+	std::vector<double> const& getColumns() const;
+	/**
+		 * @return y coordinates of the visible grid points.
 		 */
-	std::vector<RS_Vector> const& getPoints() const;
+	std::vector<double> const& getRows() const;
 
 	/**
 	* \brief the closest grid point
@@ -66,10 +77,6 @@ public:
 	*/
 	RS_Vector snapGrid(const RS_Vector& coord) const;
 
-	/**
-		 * @return Number of visible grid points.
-		 */
-	int count() const;
 	void setCrosshairType(RS2::CrosshairType chType);
 	RS2::CrosshairType getCrosshairType() const;
 
@@ -115,8 +122,9 @@ private:
 	//! Current meta grid spacing
 	double metaSpacing;
 
-	//! Pointer to array of grid points
-	std::vector<RS_Vector> pt;
+	//! Visible grid columns and rows
+	std::vector<double> columns;
+	std::vector<double> rows;
 	RS_Vector baseGrid; // the left-bottom grid point
 	RS_Vector cellV;// (dx,dy)
 	RS_Vector metaGridWidth;
@@ -127,6 +135,23 @@ private:
 	bool isometric;
 	RS2::CrosshairType crosshairType;
 
+	//! \{ application settings, see loadSettings()
+	bool scaleGrid;
+	int minGridSpacing;
+	bool settingsIsometric;
+	RS2::CrosshairType settingsCrosshairType;
+	RS_Vector settingsUserGrid;
+	//! \}
+
+	//! \{ grid width and what it was determined for
+	RS_Vector gridWidth;
+	bool layoutValid=false;
+	RS_Vector layoutFactor;
+	RS_Vector layoutUserGrid;
+	RS2::Unit layoutUnit;
+	RS2::LinearFormat layoutFormat;
+	bool layoutIsometric;
+	//! \}
 };
 
 #endif
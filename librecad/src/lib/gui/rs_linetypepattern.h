@@ -81,4 +81,16 @@ struct RS_LineTypePattern {
     static const RS_LineTypePattern patternSelected;
 };
 
+/**
+ * A line type pattern scaled to the pixels of a paint device.
+ *
+ * @see RS_GraphicView::getDashPattern()
+ */
+struct RS_DashPattern {
+	//! dashes (positive) and gaps (negative), at least one pixel long
+	std::vector<double> dashes;
+	//! sum of the lengths of the dashes and gaps
+	double length=0.;
+};
+
 #endif
@@ -137,6 +137,14 @@ void RS_Painter::createEllipse(QPolygon& pa,
            toScreenY(vp.y));
 }
 
+void RS_Painter::drawGridPoints(const std::vector<double>& x,
+                                const std::vector<double>& y) {
+    for (double py: y) {
+        for (double px: x)
+            drawGridPoint(RS_Vector(px, py));
+    }
+}
+
 void RS_Painter::drawRect(const RS_Vector& p1, const RS_Vector& p2) {
     drawPolygon(QRect(int(p1.x+0.5), int(p1.y+0.5), int(p2.x - p1.x+0.5), int(p2.y - p1.y+0.5)));
 //    drawLine(RS_Vector(p1.x, p1.y), RS_Vector(p2.x, p1.y));
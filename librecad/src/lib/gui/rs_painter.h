@@ -34,6 +34,7 @@ class RS_Color;
 class RS_Pen;
 class QPainterPath;
 class QRectF;
+class QTransform;
 
 /**
  * This class is a common interface for a painter class. Such
@@ -81,6 +82,12 @@ public:
     virtual void lineTo(int x, int y) = 0;
 
     virtual void drawGridPoint(const RS_Vector& p) = 0;
+    /**
+     * Draws a grid point at each combination of the screen
+     * coordinates x and y.
+     */
+    virtual void drawGridPoints(const std::vector<double>& x,
+                                const std::vector<double>& y);
     virtual void drawPoint(const RS_Vector& p) = 0;
     virtual void drawLine(const RS_Vector& p1, const RS_Vector& p2) = 0;
     virtual void drawRect(const RS_Vector& p1, const RS_Vector& p2);
@@ -124,6 +131,8 @@ public:
                               const RS_Vector& p3) = 0;
 
     virtual void drawPath ( const QPainterPath & path ) = 0;
+    /** draws path mapped by transform */
+    virtual void drawPath(const QPainterPath& path, const QTransform& transform) = 0;
     virtual void drawHandle(const RS_Vector& p, const RS_Color& c, int size=-1);
 
     virtual RS_Pen getPen() const = 0;
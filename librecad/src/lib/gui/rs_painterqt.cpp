@@ -25,10 +25,14 @@
 **********************************************************************/
 
 
+#include <algorithm>
 #include "rs_painterqt.h"
 #include "rs_math.h"
 
 namespace {
+//! collected primitives after which flush() is called anyway
+const int maxBatchSize = 4096;
+
 /**
  * Wrapper for Qt
  * convert RS2::LineType to Qt::PenStyle
@@ -85,6 +89,62 @@ Qt::PenStyle rsToQtLineType(RS2::LineType t) {
 RS_PainterQt::RS_PainterQt( QPaintDevice* pd)
         : QPainter(pd), RS_Painter() {}
 
+RS_PainterQt::~RS_PainterQt() {
+    if (isActive())
+        flush();
+}
+
+void RS_PainterQt::flush() {
+    if (!lineBatch.isEmpty()) {
+        QPainter::drawLines(lineBatch);
+        lineBatch.clear();
+    }
+    if (!pointBatch.isEmpty()) {
+        QPainter::drawPoints(pointBatch.constData(), pointBatch.size());
+        pointBatch.clear();
+    }
+    for (const QPolygon& pa: polylineBatch)
+        QPainter::drawPolyline(pa);
+    polylineBatch.clear();
+}
+
+bool RS_PainterQt::end() {
+    flush();
+    return QPainter::end();
+}
+
+void RS_PainterQt::applyPen(const QPen& pen) {
+    if (pen == QPainter::pen())
+        return;
+    flush();
+    QPainter::setPen(pen);
+}
+
+void RS_PainterQt::addLine(const QLine& line) {
+    lineBatch.append(line);
+    if (lineBatch.size() >= maxBatchSize)
+        flush();
+}
+
+/**
+ * Polylines of opaque solid pens are collected as lines, they look the
+ * same without antialiasing. Others keep their joins and dash patterns.
+ */
+void RS_PainterQt::addPolyline(const QPolygon& pa) {
+    if (pa.size() < 2)
+        return;
+    const QPen& p = QPainter::pen();
+    if (p.style() == Qt::SolidLine && p.color().alpha() == 255
+            && !testRenderHint(Antialiasing)) {
+        for (int i = 1; i < pa.size(); ++i)
+            addLine(QLine(pa.at(i - 1), pa.at(i)));
+        return;
+    }
+    polylineBatch.append(pa);
+    if (polylineBatch.size() >= maxBatchSize)
+        flush();
+}
+
 void RS_PainterQt::moveTo(int x, int y) {
         //RVT_PORT changed from QPainter::moveTo(x,y);
         rememberX=x;
@@ -94,6 +154,7 @@ void RS_PainterQt::moveTo(int x, int y) {
 
 void RS_PainterQt::lineTo(int x, int y) {
         // RVT_PORT changed from QPainter::lineTo(x, y);
+        flush();
         QPainterPath path;
         path.moveTo(rememberX,rememberY);
         path.lineTo(x,y);
@@ -106,19 +167,60 @@ void RS_PainterQt::lineTo(int x, int y) {
  * Draws a grid point at (x1, y1).
  */
 void RS_PainterQt::drawGridPoint(const RS_Vector& p) {
-    QPainter::drawPoint(toScreenX(p.x), toScreenY(p.y));
+    pointBatch.append(QPoint(toScreenX(p.x), toScreenY(p.y)));
+    if (pointBatch.size() >= maxBatchSize)
+        flush();
 }
 
 
 
+/**
+ * Draws the grid points of a row into an image, which is then drawn
+ * for every row. Pens not setting exactly one pixel per point draw
+ * the points one by one.
+ */
+void RS_PainterQt::drawGridPoints(const std::vector<double>& x,
+                                  const std::vector<double>& y) {
+    const QPen& p = QPainter::pen();
+    if (p.widthF() > 1. || p.style() != Qt::SolidLine
+            || testRenderHint(Antialiasing) || !worldTransform().isIdentity()) {
+        RS_Painter::drawGridPoints(x, y);
+        return;
+    }
+    // columns within the device:
+    int x0 = getWidth();
+    int x1 = -1;
+    for (double px: x) {
+        int const sx = toScreenX(px);
+        if (sx >= 0 && sx < getWidth()) {
+            x0 = std::min(x0, sx);
+            x1 = std::max(x1, sx);
+        }
+    }
+    if (x0 > x1 || y.empty())
+        return;
+
+    QImage row(x1 - x0 + 1, 1, QImage::Format_ARGB32);
+    row.fill(Qt::transparent);
+    QRgb const color = p.color().rgba();
+    for (double px: x) {
+        int const sx = toScreenX(px);
+        if (sx >= x0 && sx <= x1)
+            row.setPixel(sx - x0, 0, color);
+    }
+    flush();
+    for (double py: y)
+        QPainter::drawImage(x0, toScreenY(py), row);
+}
+
 /**
  * Draws a point at (x1, y1).
  */
 void RS_PainterQt::drawPoint(const RS_Vector& p) {
-    QPainter::drawLine(toScreenX(p.x-1), toScreenY(p.y),
-                       toScreenX(p.x+1), toScreenY(p.y));
-    QPainter::drawLine(toScreenX(p.x), toScreenY(p.y-1),
-                       toScreenX(p.x), toScreenY(p.y+1));
+    addLine(QLine(toScreenX(p.x-1), toScreenY(p.y),
+                  toScreenX(p.x+1), toScreenY(p.y)));
+    addLine(QLine(toScreenX(p.x), toScreenY(p.y-1),
+                  toScreenX(p.x), toScreenY(p.y+1)));
 }
 
 
@@ -132,8 +234,8 @@ void RS_PainterQt::drawLine(const RS_Vector& p1, const RS_Vector& p2) {
     QPainter::drawLine(toScreenX(p1.x-w2), toScreenY(p1.y-w2),
                        toScreenX(p2.x-w2), toScreenY(p2.y-w2));
 #else
-    QPainter::drawLine(toScreenX(p1.x), toScreenY(p1.y),
-                       toScreenX(p2.x), toScreenY(p2.y));
+    addLine(QLine(toScreenX(p1.x), toScreenY(p1.y),
+                  toScreenX(p2.x), toScreenY(p2.y)));
 #endif
 }
 
@@ -232,7 +334,7 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
             //lineTo(toScreenX(p2.x), toScreenY(p2.y));
             pa.resize(i+1);
             pa.setPoint(i++, toScreenX(p2.x), toScreenY(p2.y));
-            drawPolyline(pa);
+            addPolyline(pa);
         } else {
             // Arc Clockwise:
             if(a1<a2+1.0e-10) {
@@ -253,7 +355,7 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
             //lineTo(toScreenX(p2.x), toScreenY(p2.y));
             pa.resize(i+1);
             pa.setPoint(i++, toScreenX(p2.x), toScreenY(p2.y));
-            drawPolyline(pa);
+            addPolyline(pa);
         }
 #endif
     }
@@ -282,7 +384,7 @@ void RS_PainterQt::drawArc(const RS_Vector& cp, double radius,
 #else
         QPolygon pa;
         createArc(pa, cp, radius, a1, a2, reversed);
-        drawPolyline(pa);
+        addPolyline(pa);
 #endif
     }
 }
@@ -391,6 +493,7 @@ void RS_PainterQt::drawCircle(const RS_Vector& cp, double radius) {
 // RVT_PORT    if (drawingMode==RS2::ModeXOR && radius<500) {
                 if (radius<500) {
         // This is _very_ slow for large arcs:
+        flush();
         QPainter::drawEllipse(toScreenX(cp.x-radius),
                               toScreenY(cp.y-radius),
                               RS_Math::round(2.0*radius),
@@ -424,7 +527,7 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
                                bool reversed) {
     QPolygon pa;
     createEllipse(pa, cp, radius1, radius2, angle, a1, a2, reversed);
-    drawPolyline(pa);
+    addPolyline(pa);
 }
 
 
@@ -434,6 +537,7 @@ void RS_PainterQt::drawEllipse(const RS_Vector& cp,
  */
 void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
                            double angle, const RS_Vector& factor) {
+    flush();
     save();
 
     // Render smooth only at close zooms
@@ -461,6 +565,7 @@ void RS_PainterQt::drawImg(QImage& img, const RS_Vector& pos,
 void RS_PainterQt::drawTextH(int x1, int y1,
                              int x2, int y2,
                              const QString& text) {
+    flush();
     drawText(x1, y1, x2, y2,
              Qt::AlignRight|Qt::AlignVCenter,
              text);
@@ -471,6 +576,7 @@ void RS_PainterQt::drawTextH(int x1, int y1,
 void RS_PainterQt::drawTextV(int x1, int y1,
                              int x2, int y2,
                              const QString& text) {
+    flush();
     save();
     QMatrix wm = worldMatrix();
     wm.rotate(-90.0);
@@ -486,6 +592,7 @@ void RS_PainterQt::drawTextV(int x1, int y1,
 
 void RS_PainterQt::fillRect(int x1, int y1, int w, int h,
                             const RS_Color& col) {
+    flush();
     QPainter::fillRect(x1, y1, w, h, col);
 }
 
@@ -507,6 +614,7 @@ void RS_PainterQt::fillTriangle(const RS_Vector& p1,
 
 
 void RS_PainterQt::erase() {
+    flush();
     QPainter::eraseRect(0,0,getWidth(),getHeight());
 }
 
@@ -552,16 +660,16 @@ void RS_PainterQt::setPen(const RS_Pen& pen) {
 		   rsToQtLineType(lpen.getLineType()));
     p.setJoinStyle(Qt::RoundJoin);
     p.setCapStyle(Qt::RoundCap);
-    QPainter::setPen(p);
+    applyPen(p);
 }
 
 void RS_PainterQt::setPen(const RS_Color& color) {
     if (drawingMode==RS2::ModeBW) {
         lpen.setColor(RS_Color(0,0,0));
-        QPainter::setPen(RS_Color(0,0,0));
+        applyPen(QPen(RS_Color(0,0,0)));
     } else {
         lpen.setColor(color);
-        QPainter::setPen(color);
+        applyPen(QPen(color));
     }
 }
 
@@ -575,7 +683,7 @@ void RS_PainterQt::setPen(int r, int g, int b) {
 
 void RS_PainterQt::disablePen() {
     lpen = RS_Pen(RS2::FlagInvalid);
-    QPainter::setPen(Qt::NoPen);
+    applyPen(QPen(Qt::NoPen));
 }
 
 void RS_PainterQt::setBrush(const RS_Color& color) {
@@ -591,20 +699,32 @@ void RS_PainterQt::setBrush(const QBrush& color) {
 }
 
 void RS_PainterQt::drawPolygon(const QPolygon& a, Qt::FillRule rule) {
+    flush();
     QPainter::drawPolygon(a,rule);
 }
 
 void RS_PainterQt::drawPath ( const QPainterPath & path ) {
+    flush();
+    QPainter::drawPath(path);
+}
+
+void RS_PainterQt::drawPath(const QPainterPath& path, const QTransform& transform) {
+    flush();
+    const QTransform saved = worldTransform();
+    setWorldTransform(transform, true);
     QPainter::drawPath(path);
+    setWorldTransform(saved);
 }
 
 
 void RS_PainterQt::setClipRect(int x, int y, int w, int h) {
+    flush();
     QPainter::setClipRect(x, y, w, h);
     setClipping(true);
 }
 
 void RS_PainterQt::resetClipping() {
+    flush();
     setClipping(false);
 }
 
@@ -615,6 +735,7 @@ void RS_PainterQt::fillRect ( const QRectF & rectangle, const RS_Color & color )
         double y1=rectangle.top();
         double y2=rectangle.bottom();
 
+        flush();
         QPainter::fillRect(toScreenX(x1),toScreenY(y1),toScreenX(x2)-toScreenX(x1),toScreenY(y2)-toScreenX(y1), color);
 }
 void RS_PainterQt::fillRect ( const QRectF & rectangle, const QBrush & brush ) {
@@ -622,5 +743,6 @@ void RS_PainterQt::fillRect ( const QRectF & rectangle, const QBrush & brush ) {
         double x2=rectangle.right();
         double y1=rectangle.top();
         double y2=rectangle.bottom();
+        flush();
         QPainter::fillRect(toScreenX(x1),toScreenY(y1),toScreenX(x2),toScreenY(y2), brush);
 }
@@ -29,6 +29,7 @@
 #define RS_PAINTERQT_H
 
 #include <QPainter>
+#include <QVector>
 
 #include "rs_painter.h"
 #include "rs_pen.h"
@@ -37,16 +38,27 @@
  * The Qt implementation of a painter. It can draw objects such as
  * lines or arcs in a widget. All coordinates are screen coordinates
  * and have nothing to do with the graphic view.
+ *
+ * Lines, points and polylines are collected while the pen stays the
+ * same and drawn together by flush(), which is called before the pen
+ * changes, before any other primitive and by end().
  */
 class RS_PainterQt: public QPainter, public RS_Painter {
 
 public:
     RS_PainterQt( QPaintDevice* pd);
-    virtual ~RS_PainterQt()=default;
+    virtual ~RS_PainterQt();
+
+    /** draws the collected lines, points and polylines */
+    void flush();
+    /** flushes and ends painting, hides QPainter::end() */
+    bool end();
 
     virtual void moveTo(int x, int y);
     virtual void lineTo(int x, int y);
     virtual void drawGridPoint(const RS_Vector& p);
+    virtual void drawGridPoints(const std::vector<double>& x,
+                                const std::vector<double>& y);
     virtual void drawPoint(const RS_Vector& p);
     virtual void drawLine(const RS_Vector& p1, const RS_Vector& p2);
     //virtual void drawRect(const RS_Vector& p1, const RS_Vector& p2);
@@ -85,6 +97,7 @@ public:
 
     virtual void drawPolygon(const QPolygon& a,Qt::FillRule rule=Qt::WindingFill);
     virtual void drawPath ( const QPainterPath & path );
+    virtual void drawPath(const QPainterPath& path, const QTransform& transform);
     virtual void erase();
     virtual int getWidth() const;
     /** get Density per millimeter on screen/print device
@@ -108,7 +121,16 @@ public:
     virtual void resetClipping();
 
 protected:
+    /** sets the Qt pen, flushes first if it differs from the current one */
+    void applyPen(const QPen& pen);
+    void addPolyline(const QPolygon& pa);
+    void addLine(const QLine& line);
+
     RS_Pen lpen;
+    //! lines, points and polylines of the current pen waiting for flush()
+    QVector<QLine> lineBatch;
+    QVector<QPoint> pointBatch;
+    QVector<QPolygon> polylineBatch;
     long rememberX; // Used for the moment because QPainter doesn't support moveTo anymore, thus we need to remember ourselve the moveTo positions
     long rememberY;
 };
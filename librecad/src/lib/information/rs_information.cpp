@@ -37,6 +37,7 @@
 #include "rs_line.h"
 #include "lc_quadratic.h"
 #include "lc_splinepoints.h"
+#include "rs_spline.h"
 #include "rs_math.h"
 #include "lc_rect.h"
 
@@ -256,7 +257,11 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
         }
     }
 
-	if(e1->rtti() == RS2::EntitySplinePoints || e2->rtti() == RS2::EntitySplinePoints)
+	if(e1->rtti() == RS2::EntitySpline || e2->rtti() == RS2::EntitySpline)
+	{
+		ret = RS_Spline::getIntersection(e1, e2);
+	}
+	else if(e1->rtti() == RS2::EntitySplinePoints || e2->rtti() == RS2::EntitySplinePoints)
 	{
 		ret = LC_SplinePoints::getIntersection(e1, e2);
 	}
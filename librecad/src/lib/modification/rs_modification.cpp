@@ -42,6 +42,7 @@
 #include "rs_text.h"
 #include "rs_layer.h"
 #include "lc_splinepoints.h"
+#include "lc_undodelta.h"
 #include "rs_math.h"
 
 #include "rs_dialogfactory.h"
@@ -95,25 +96,32 @@ void RS_Modification::remove() {
         return;
     }
 
-    if (document) {
-        document->startUndoCycle();
+    if (!document) {
+        // without undo, the entities are deleted in one batch
+        std::unordered_set<RS_Entity*> toRemove;
+        for(auto e: *container){
+            if (e && e->isSelected()) {
+                toRemove.insert(e);
+            }
+        }
+        container->removeEntities(toRemove);
+        graphicView->redraw(RS2::RedrawDrawing);
+        return;
     }
 
+    document->startUndoCycle();
+
 	// not safe (?)
 	for(auto e: *container){
 
         if (e && e->isSelected()) {
             e->setSelected(false);
             e->changeUndoState();
-            if (document) {
-                document->addUndoable(e);
-            }
+            document->addUndoable(e);
         }
     }
 
-    if (document) {
-        document->endUndoCycle();
-    }
+    document->endUndoCycle();
 
     graphicView->redraw(RS2::RedrawDrawing);
 }
@@ -164,23 +172,22 @@ bool RS_Modification::changeAttributes(RS_AttributesData& data) {
         return false;
     }
 
-	std::vector<RS_Entity*> addList;
-
     if (document) {
         document->startUndoCycle();
     }
 
+    // attributes are changed in place, the undo cycle stores the
+    // previous and the new layers and pens
+    LC_AttributesDelta* delta = new LC_AttributesDelta();
 	for(auto e: *container){
-        //for (unsigned i=0; i<container->count(); ++i) {
-        //RS_Entity* e = container->entityAt(i);
         if (e && e->isSelected()) {
-            RS_Entity* ec = e->clone();
-            ec->setSelected(false);
+            delta->addEntity(e);
+            e->setSelected(false);
 
-            RS_Pen pen = ec->getPen(false);
+            RS_Pen pen = e->getPen(false);
 
             if (data.changeLayer==true) {
-                ec->setLayer(data.layer);
+                e->setLayer(data.layer);
             }
 
             if (data.changeColor==true) {
@@ -193,27 +200,17 @@ bool RS_Modification::changeAttributes(RS_AttributesData& data) {
                 pen.setWidth(data.pen.getWidth());
             }
 
-            ec->setPen(pen);
-
-            //if (data.useCurrentLayer) {
-            //    ec->setLayerToActive();
-            //}
-            //if (data.useCurrentAttributes) {
-            //    ec->setPenToActive();
-            //}
-            //if (ec->rtti()==RS2::EntityInsert) {
-            //    ((RS_Insert*)ec)->update();
-            //}
-            ec->update();
-			addList.push_back(ec);
+            e->setPen(pen);
+            e->update();
         }
     }
-
-    deselectOriginals(true);
-    addNewEntities(addList);
+    delta->finish();
 
     if (document) {
+        document->addDelta(delta);
         document->endUndoCycle();
+    } else {
+        delete delta;
     }
 
     if (graphicView) {
@@ -450,7 +447,8 @@ void RS_Modification::paste(const RS_PasteData& data, RS_Graphic* source) {
 				name=blks->newName(name);
 			}
 			blocksDict[b->getName()] = name;
-			b->setName(name);
+			if (name != b->getName())
+				blks->rename(b, name);
 		}
 
         //add new blocks with new names
@@ -1442,6 +1440,14 @@ bool RS_Modification::move(RS_MoveData& data) {
         return false;
     }
 
+	if (data.number==0) {
+		// moved in place, the undo cycle stores the offset only
+		transformSelected(new LC_TransformDelta(LC_TransformDelta::Move,
+												data.offset),
+						  data.useCurrentLayer, data.useCurrentAttributes, true);
+		return true;
+	}
+
 	std::vector<RS_Entity*> addList;
 
     if (document && handleUndo) {
@@ -1565,6 +1571,14 @@ bool RS_Modification::rotate(RS_RotateData& data) {
         return false;
     }
 
+	if (data.number==0) {
+		transformSelected(new LC_TransformDelta(LC_TransformDelta::Rotate,
+												data.center, RS_Vector(false),
+												data.angle),
+						  data.useCurrentLayer, data.useCurrentAttributes, false);
+		return true;
+	}
+
 	std::vector<RS_Entity*> addList;
 
     if (document && handleUndo) {
@@ -1624,6 +1638,18 @@ bool RS_Modification::scale(RS_ScaleData& data) {
         return false;
     }
 
+	// isotropic scaling keeps the entity types and can be undone by
+	// scaling with the inverse factor
+	if (data.number==0
+			&& fabs(data.factor.x - data.factor.y) <= RS_TOLERANCE
+			&& fabs(data.factor.x) > RS_TOLERANCE
+			&& fabs(data.factor.y) > RS_TOLERANCE) {
+		transformSelected(new LC_TransformDelta(LC_TransformDelta::Scale,
+												data.referencePoint, data.factor),
+						  data.useCurrentLayer, data.useCurrentAttributes, false);
+		return true;
+	}
+
 	std::vector<RS_Entity*> selectedList,addList;
 
     if (document && handleUndo) {
@@ -1713,6 +1739,13 @@ bool RS_Modification::mirror(RS_MirrorData& data) {
         return false;
     }
 
+	if (data.copy==false) {
+		transformSelected(new LC_TransformDelta(LC_TransformDelta::Mirror,
+												data.axisPoint1, data.axisPoint2),
+						  data.useCurrentLayer, data.useCurrentAttributes, false);
+		return true;
+	}
+
 	std::vector<RS_Entity*> addList;
 
     if (document && handleUndo) {
@@ -1884,6 +1917,92 @@ bool RS_Modification::moveRotate(RS_MoveRotateData& data) {
 
 
 
+/**
+ * Transforms the selected entities in place. Instead of copies of the
+ * entities, the undo cycle stores the data before and after the
+ * transformation and the changed layers and pens. Entities which can't
+ * be restored from their data are replaced by transformed copies, like
+ * all entities of documents whose undo is handled by the caller. Only
+ * containers without a document, e.g. previews, are always transformed
+ * in place.
+ *
+ * @param delta Transformation to apply, ownership is taken.
+ * @param keepSelection false: deselect the transformed entities.
+ */
+void RS_Modification::transformSelected(LC_TransformDelta* delta,
+										bool useCurrentLayer,
+										bool useCurrentAttributes,
+										bool keepSelection) {
+	std::unique_ptr<LC_TransformDelta> transform(delta);
+	std::unique_ptr<LC_AttributesDelta> attributes;
+	if (useCurrentLayer || useCurrentAttributes) {
+		attributes.reset(new LC_AttributesDelta());
+	}
+
+	bool const undoable = document && handleUndo;
+	std::vector<RS_Entity*> addList;
+
+	if (undoable) {
+		document->startUndoCycle();
+	}
+
+	for(auto e: *container){
+		if (e && e->isSelected()) {
+			if (!document) {
+				transform->apply(e);
+			} else if (!(undoable && transform->transform(e))) {
+				RS_Entity* ec = e->clone();
+				transform->apply(ec);
+				if (useCurrentLayer) {
+					ec->setLayerToActive();
+				}
+				if (useCurrentAttributes) {
+					ec->setPenToActive();
+				}
+				ec->setSelected(keepSelection);
+				addList.push_back(ec);
+
+				e->setSelected(false);
+				e->changeUndoState();
+				if (undoable) {
+					document->addUndoable(e);
+				}
+				continue;
+			}
+			if (attributes) {
+				attributes->addEntity(e);
+				if (useCurrentLayer) {
+					e->setLayerToActive();
+				}
+				if (useCurrentAttributes) {
+					e->setPenToActive();
+				}
+			}
+			if (!keepSelection) {
+				e->setSelected(false);
+			}
+		}
+	}
+
+	addNewEntities(addList);
+
+	if (undoable) {
+		if (attributes && !attributes->isEmpty()) {
+			attributes->finish();
+			document->addDelta(attributes.release());
+		}
+		if (!transform->isEmpty()) {
+			document->addDelta(transform.release());
+		}
+		document->endUndoCycle();
+	}
+
+	if (graphicView) {
+		graphicView->redraw(RS2::RedrawDrawing);
+	}
+}
+
+
 /**
  * Deselects all selected entities and removes them if remove is true;
  *
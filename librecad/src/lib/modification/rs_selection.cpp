@@ -316,25 +316,35 @@ void RS_Selection::selectLayer(RS_Entity* e) {
  */
 void RS_Selection::selectLayer(const QString& layerName, bool select) {
 
-	for(auto en: *container){
-
-        if (en && en->isVisible() && 
-				en->isSelected()!=select && 
-				(!(en->getLayer() && en->getLayer()->isLocked()))) {
-
-            RS_Layer* l = en->getLayer(true);
+    auto selectEntity = [select](RS_Entity* en) {
+        if (en && en->isVisible() &&
+                en->isSelected()!=select &&
+                (!(en->getLayer() && en->getLayer()->isLocked()))) {
+            en->setSelected(select);
+        }
+    };
 
+    if (graphic && graphic==container) {
+        // only visit the entities on the layer
+        RS_Layer* layer = graphic->findLayer(layerName);
+        if (!layer) {
+            return;
+        }
+        for(auto en: graphic->getLayerEntities(layer)){
+            selectEntity(en);
+        }
+    } else {
+        for(auto en: *container){
+            RS_Layer* l = en ? en->getLayer(true) : nullptr;
             if (l && l->getName()==layerName) {
-                if (graphicView) {
-                    graphicView->deleteEntity(en);
-                }
-                en->setSelected(select);
-                if (graphicView) {
-                    graphicView->drawEntity(en);
-                }
+                selectEntity(en);
             }
         }
     }
+
+    if (graphicView) {
+        graphicView->redraw(RS2::RedrawDrawing);
+    }
 }
 
 // EOF
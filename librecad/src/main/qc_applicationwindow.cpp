@@ -29,11 +29,13 @@
 #include "qc_mdiwindow.h"
 
 #include <QStatusBar>
+#include <QLabel>
 #include <QMenuBar>
 #include <QDockWidget>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QTimer>
+#include <QProgressDialog>
 #include <QSplitter>
 #include <QMdiArea>
 #include <QPluginLoader>
@@ -60,6 +62,7 @@
 #include "rs_painterqt.h"
 #include "rs_selection.h"
 #include "rs_document.h"
+#include "rs_grid.h"
 
 #include "qg_snaptoolbar.h"
 #include "qg_blockwidget.h"
@@ -89,6 +92,7 @@
 #include "lc_actionfactory.h"
 #include "lc_dockwidget.h"
 #include "lc_customtoolbar.h"
+#include "lc_documentloader.h"
 
 
 QC_ApplicationWindow* QC_ApplicationWindow::appWindow = nullptr;
@@ -688,6 +692,14 @@ void QC_ApplicationWindow::setRedoEnable(bool enable){
     }
 }
 
+void QC_ApplicationWindow::setUndoMemoryUsage(size_t bytes){
+    if(undoMemoryLabel){
+        undoMemoryLabel->setText(bytes < 1024*1024
+                                 ? tr("Undo: %1 KiB").arg((bytes + 1023)/1024)
+                                 : tr("Undo: %1 MiB").arg(bytes/(1024.*1024.), 0, 'f', 1));
+    }
+}
+
 void QC_ApplicationWindow::slotEnableActions(bool enable) {
     if(previousZoom){
         previousZoom->setEnabled(enable&& previousZoomEnable);
@@ -711,6 +723,10 @@ void QC_ApplicationWindow::initStatusBar() {
     statusBar()->addWidget(selectionWidget);
     m_pActiveLayerName=new QG_ActiveLayerName(this);
     statusBar()->addWidget(m_pActiveLayerName);
+    undoMemoryLabel = new QLabel(statusBar());
+    undoMemoryLabel->setToolTip(tr("Memory used by the undo history"));
+    statusBar()->addPermanentWidget(undoMemoryLabel);
+    setUndoMemoryUsage(0);
 }
 
 void QC_ApplicationWindow::slotUpdateActiveLayer()
@@ -1627,6 +1643,33 @@ void QC_ApplicationWindow::
             commandWidget->appendHistory(message);
             statusBar()->showMessage(message, 2000);
         }
+
+        if (LC_DocumentLoader::canLoad(fileName, type)) {
+            // load in the background, the window is created for the
+            // complete drawing in slotFileLoaded()
+            QString const message=tr("Loading %1...")
+                    .arg(QFileInfo(fileName).fileName());
+            QProgressDialog* dialog = new QProgressDialog(message, tr("Cancel"),
+                                                          0, 100, this);
+            dialog->setWindowModality(Qt::NonModal);
+            dialog->setMinimumDuration(500);
+            dialog->setAutoClose(false);
+            dialog->setAutoReset(false);
+            // deleted with the dialog
+            LC_DocumentLoader* loader = new LC_DocumentLoader(fileName, type, dialog);
+            connect(loader, SIGNAL(progress(int)),
+                    dialog, SLOT(setValue(int)));
+            connect(dialog, SIGNAL(canceled()),
+                    loader, SLOT(cancel()));
+            connect(loader, SIGNAL(finished(bool)),
+                    this, SLOT(slotFileLoaded(bool)));
+            statusBar()->showMessage(message);
+            loader->start();
+
+            QApplication::restoreOverrideCursor();
+            return;
+        }
+
         // Create new document window:
         QMdiSubWindow* old=activedMdiSubWindow;
         QRect geo;
@@ -1689,48 +1732,94 @@ void QC_ApplicationWindow::
 
         RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: open file: OK");
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update recent file menu: 1");
+        slotFileOpenHelper(fileName, w);
+    }
+         else
+         {
+        QG_DIALOGFACTORY->commandMessage(tr("File '%1' does not exist. Opening aborted").arg(fileName));
+        statusBar()->showMessage(tr("Opening aborted"), 2000);
+    }
 
-        // update recent files menu:
-        recentFiles->add(fileName);
-        openedFiles.push_back(fileName);
-        layerWidget->slotUpdateLayerList();
-        if (w->getGraphic()) {
-            emit(gridChanged(w->getGraphic()->isGridOn()));
+    QApplication::restoreOverrideCursor();
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(..) OK");
+}
+
+
+/**
+ * Creates the window for a file loaded in the background by
+ * slotFileOpen(), the sender is the LC_DocumentLoader.
+ */
+void QC_ApplicationWindow::slotFileLoaded(bool success)
+{
+    LC_DocumentLoader* loader = qobject_cast<LC_DocumentLoader*>(sender());
+    if (!loader)
+        return;
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileLoaded(%s)",
+                    loader->getFileName().toLatin1().data());
+    QString const fileName = loader->getFileName();
+    // the progress dialog, deletes the loader
+    loader->parent()->deleteLater();
+
+    if (!success) {
+        if (loader->isCancelled()) {
+            commandWidget->appendHistory(tr("Opening aborted: ")+fileName);
+            statusBar()->showMessage(tr("Opening aborted"), 2000);
+            return;
         }
+        QString msg=tr("Cannot open the file\n%1\nPlease "
+                       "check its existence and permissions.")
+                .arg(fileName);
+        commandWidget->appendHistory(msg);
+        QMessageBox::information(this, QMessageBox::tr("Warning"),
+                                 msg,
+                                 QMessageBox::Ok);
+        return;
+    }
 
-        recentFiles->updateRecentFilesMenu();
+    QC_MDIWindow* w = slotFileNew(loader->takeGraphic());
+    w->setOwner(true);
+    slotFileOpenHelper(fileName, w);
+}
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: set caption");
 
+/**
+ * Helper function for opening files, updates the application for the
+ * window w showing the opened file.
+ */
+void QC_ApplicationWindow::slotFileOpenHelper(const QString& fileName, QC_MDIWindow* w)
+{
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update recent file menu: 1");
 
-                /*	Format and set caption.
-                 *	----------------------- */
-        w->setWindowTitle(format_filename_caption(fileName));
-        updateWindowTitle(w);
+    // update recent files menu:
+    recentFiles->add(fileName);
+    openedFiles.push_back(fileName);
+    layerWidget->slotUpdateLayerList();
+    if (w->getGraphic()) {
+        emit(gridChanged(w->getGraphic()->isGridOn()));
+    }
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: set caption: OK");
+    recentFiles->updateRecentFilesMenu();
 
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update coordinate widget");
-        // update coordinate widget format:
-        RS_DIALOGFACTORY->updateCoordinateWidget(RS_Vector(0.0,0.0),
-                RS_Vector(0.0,0.0),
-                true);
-        RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update coordinate widget: OK");
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: set caption");
 
-        QString message=tr("Loaded document: ")+fileName;
-        commandWidget->appendHistory(message);
-        statusBar()->showMessage(message, 2000);
 
-    }
-         else
-         {
-        QG_DIALOGFACTORY->commandMessage(tr("File '%1' does not exist. Opening aborted").arg(fileName));
-        statusBar()->showMessage(tr("Opening aborted"), 2000);
-    }
+            /*	Format and set caption.
+             *	----------------------- */
+    w->setWindowTitle(format_filename_caption(fileName));
+    updateWindowTitle(w);
 
-    QApplication::restoreOverrideCursor();
-    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen(..) OK");
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: set caption: OK");
+
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update coordinate widget");
+    // update coordinate widget format:
+    RS_DIALOGFACTORY->updateCoordinateWidget(RS_Vector(0.0,0.0),
+            RS_Vector(0.0,0.0),
+            true);
+    RS_DEBUG->print("QC_ApplicationWindow::slotFileOpen: update coordinate widget: OK");
+
+    QString message=tr("Loaded document: ")+fileName;
+    commandWidget->appendHistory(message);
+    statusBar()->showMessage(message, 2000);
 }
 
 
@@ -2040,6 +2129,7 @@ bool QC_ApplicationWindow::slotFileExport(const QString& name,
             e; e=graphic->nextEntity(RS2::ResolveAll)) {
         gv.drawEntity(&painter, e);
     }
+    painter.flush();
 
     // end the picture output
     if(format.toLower() != "svg")
@@ -2562,6 +2652,7 @@ void QC_ApplicationWindow::slotOptionsGeneral() {
                 gv->setHandleColor(handleColor);
                 gv->setEndHandleColor(endHandleColor);
 				gv->set_antialiasing(antialiasing?true:false);
+                gv->getGrid()->loadSettings();
                 gv->redraw(RS2::RedrawGrid);
             }
         }
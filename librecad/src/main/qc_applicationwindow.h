@@ -55,6 +55,7 @@ class QG_PenToolBar;
 class QHelpEngine;
 class QC_PluginInterface;
 class QG_ActiveLayerName;
+class QLabel;
 class LC_SimpleTests;
 class LC_CustomToolbar;
 class QG_ActionHandler;
@@ -91,6 +92,7 @@ public:
     virtual void keyReleaseEvent(QKeyEvent* e);
     void setRedoEnable(bool enable);
     void setUndoEnable(bool enable);
+    void setUndoMemoryUsage(size_t bytes);
 
 public slots:
     void slot_set_action(QAction* q_action);
@@ -190,6 +192,9 @@ public slots:
 
     void hide_options(QC_MDIWindow*);
 
+    /** shows a file loaded in the background, see slotFileOpen() */
+    void slotFileLoaded(bool success);
+
 signals:
     void gridChanged(bool on);
     void draftChanged(bool on);
@@ -302,6 +307,8 @@ private:
     QString format_filename_caption(const QString &qstring_in);
     /** Helper function for Menu file -> New & New.... */
 	bool slotFileNewHelper(QString fileName, QC_MDIWindow* w = nullptr);
+    /** Helper function for Menu file -> Open, updates the application */
+    void slotFileOpenHelper(const QString& fileName, QC_MDIWindow* w);
 
     /**
      * @brief updateWindowTitle, for draft mode, add "Draft Mode" to window title
@@ -346,6 +353,8 @@ private:
     /** Selection Status */
     QG_SelectionWidget* selectionWidget;
     QG_ActiveLayerName* m_pActiveLayerName;
+    /** Memory held by the undo list of the active document */
+    QLabel* undoMemoryLabel{nullptr};
 
     /** Option widget for individual tool options */
     QToolBar* optionWidget;
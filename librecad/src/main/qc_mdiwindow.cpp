@@ -137,6 +137,10 @@ void QC_MDIWindow::setForceClosing(bool on) {
 	forceClosing = on;
 }
 
+void QC_MDIWindow::setOwner(bool on) {
+	owner = on;
+}
+
 RS_EventHandler* QC_MDIWindow::getEventHandler() const{
 	if (graphicView) {
 		return graphicView->getEventHandler();
@@ -343,12 +347,15 @@ bool QC_MDIWindow::slotFileOpen(const QString& fileName, RS2::FormatType type) {
     bool ret = false;
 
 	if (document && !fileName.isEmpty()) {
+        graphicView->cancelRendering();
         document->newDoc();
 
                 // cosmetics..
                 // RVT_PORT qApp->processEvents(1000);
                 qApp->processEvents(QEventLoop::AllEvents, 1000);
 
+        // the events may have started rendering the empty document
+        graphicView->cancelRendering();
         ret = document->open(fileName, type);
 
         if (ret) {
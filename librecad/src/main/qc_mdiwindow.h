@@ -94,6 +94,8 @@ public:
 	bool closeMDI(bool force, bool ask=true);
 
 	void setForceClosing(bool on);
+	/** The document is deleted with the window if the window owns it. */
+	void setOwner(bool on);
 
     friend std::ostream& operator << (std::ostream& os, QC_MDIWindow& w);
 
@@ -185,6 +185,7 @@ HEADERS += \
     lib/engine/rs_variabledict.h \
     lib/engine/rs_vector.h \
     lib/fileio/rs_fileio.h \
+    lib/fileio/lc_documentloader.h \
     lib/filters/rs_filtercxf.h \
     lib/filters/rs_filterdxfrw.h \
     lib/filters/rs_filterdxf1.h \
@@ -227,7 +228,9 @@ HEADERS += \
     ui/qg_commandhistory.h \
     ui/lc_customtoolbar.h \
     ui/lc_dockwidget.h \
-    lib/engine/lc_rect.h
+    lib/engine/lc_rect.h \
+    lib/engine/lc_spatialindex.h \
+    lib/engine/lc_undodelta.h
 
 SOURCES += \
     lib/actions/rs_actioninterface.cpp \
@@ -253,6 +256,7 @@ SOURCES += \
     lib/engine/rs_entity.cpp \
     lib/engine/rs_entitycontainer.cpp \
     lib/engine/rs_font.cpp \
+    lib/engine/rs_fontchar.cpp \
     lib/engine/rs_fontlist.cpp \
     lib/engine/rs_graphic.cpp \
     lib/engine/rs_hatch.cpp \
@@ -283,6 +287,7 @@ SOURCES += \
     lib/engine/rs_variabledict.cpp \
     lib/engine/rs_vector.cpp \
     lib/fileio/rs_fileio.cpp \
+    lib/fileio/lc_documentloader.cpp \
     lib/filters/rs_filtercxf.cpp \
     lib/filters/rs_filterdxfrw.cpp \
     lib/filters/rs_filterdxf1.cpp \
@@ -323,6 +328,8 @@ SOURCES += \
     ui/lc_customtoolbar.cpp \
     ui/lc_dockwidget.cpp \
     lib/engine/lc_rect.cpp \
+    lib/engine/lc_spatialindex.cpp \
+    lib/engine/lc_undodelta.cpp \
     lib/engine/rs.cpp
 
 # ################################################################################
@@ -607,6 +614,8 @@ RESOURCES += ../res/actions/actions.qrc
 # ################################################################################
 # UI
 HEADERS += ui/lc_actionfactory.h \
+    ui/lc_tilecache.h \
+    ui/lc_tilerenderer.h \
     ui/qg_actionhandler.h \
     ui/qg_blockwidget.h \
     ui/qg_colorbox.h \
@@ -693,6 +702,8 @@ HEADERS += ui/lc_actionfactory.h \
     ui/forms/qg_widgetpen.h
 
 SOURCES += ui/lc_actionfactory.cpp \
+    ui/lc_tilecache.cpp \
+    ui/lc_tilerenderer.cpp \
     ui/qg_actionhandler.cpp \
     ui/qg_blockwidget.cpp \
     ui/qg_colorbox.cpp \
@@ -0,0 +1,148 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <vector>
+
+#include "lc_tilecache.h"
+
+bool LC_TileCache::setFactor(const RS_Vector& f)
+{
+	if (factor.valid && factor.x == f.x && factor.y == f.y)
+		return false;
+	clear();
+	factor = f;
+	return true;
+}
+
+void LC_TileCache::clear()
+{
+	if (tiles.empty())
+		return;
+	tiles.clear();
+	++gen;
+}
+
+void LC_TileCache::invalidate(const QRect& area)
+{
+	bool changed = false;
+	for (auto& t: tiles) {
+		Tile& tile = t.second;
+		QRect const tileRect{tile.tx*TileSize, tile.ty*TileSize,
+					TileSize, TileSize};
+		if (!tile.stale && tileRect.intersects(area)) {
+			tile.stale = true;
+			changed = true;
+		}
+	}
+	if (changed)
+		++gen;
+}
+
+void LC_TileCache::invalidateAll()
+{
+	for (auto& t: tiles)
+		t.second.stale = true;
+	++gen;
+}
+
+void LC_TileCache::invalidateDrafts()
+{
+	bool changed = false;
+	for (auto& t: tiles) {
+		if (t.second.draft && !t.second.stale) {
+			t.second.stale = true;
+			changed = true;
+		}
+	}
+	if (changed)
+		++gen;
+}
+
+QPixmap* LC_TileCache::find(int tx, int ty, bool* stale)
+{
+	auto it = tiles.find(key(tx, ty));
+	if (it == tiles.end())
+		return nullptr;
+	it->second.lastUsed = frame;
+	if (stale)
+		*stale = it->second.stale;
+	return &it->second.pixmap;
+}
+
+void LC_TileCache::insert(int tx, int ty, const QPixmap& pixmap, bool draft)
+{
+	Tile& tile = tiles[key(tx, ty)];
+	tile.pixmap = pixmap;
+	tile.tx = tx;
+	tile.ty = ty;
+	tile.lastUsed = frame;
+	tile.stale = false;
+	tile.draft = draft;
+	++gen;
+}
+
+void LC_TileCache::nextFrame()
+{
+	++frame;
+}
+
+void LC_TileCache::prune(size_t maxTiles)
+{
+	if (tiles.size() <= maxTiles)
+		return;
+	std::vector<unsigned> ages;
+	ages.reserve(tiles.size());
+	for (auto const& t: tiles)
+		ages.push_back(frame - t.second.lastUsed);
+	// tiles older than the maxTiles youngest ones are dropped
+	std::nth_element(ages.begin(), ages.begin() + maxTiles, ages.end());
+	unsigned const maxAge = ages[maxTiles];
+	for (auto it = tiles.begin(); it != tiles.end() && tiles.size() > maxTiles;) {
+		if (frame - it->second.lastUsed >= maxAge)
+			it = tiles.erase(it);
+		else
+			++it;
+	}
+	++gen;
+}
+
+size_t LC_TileCache::size() const
+{
+	return tiles.size();
+}
+
+unsigned LC_TileCache::generation() const
+{
+	return gen;
+}
+
+int LC_TileCache::tileIndex(int pixel)
+{
+	// rounds towards negative infinity
+	return pixel >= 0 ? pixel/TileSize : -((-pixel - 1)/TileSize) - 1;
+}
+
+long long LC_TileCache::key(int tx, int ty)
+{
+	return (static_cast<long long>(tx) << 32)
+			| static_cast<unsigned>(ty);
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_TILECACHE_H
+#define LC_TILECACHE_H
+
+#include <unordered_map>
+#include <QPixmap>
+#include <QRect>
+#include "rs_vector.h"
+
+/**
+ * Raster cache of a drawing, split into square tiles.
+ *
+ * Tiles are addressed in world pixels: graph coordinates multiplied by
+ * the zoom factor, with y pointing down. Panning a view does not change
+ * the world pixel of an entity, so cached tiles stay valid and only
+ * newly exposed tiles have to be rendered.
+ *
+ * The cache belongs to one zoom factor and is emptied when it changes.
+ * Changed areas are only marked stale, their tiles are shown until
+ * they are rendered again. Draft tiles, rendered while the view is
+ * moved, are marked stale once it comes to rest.
+ *
+ * @see QG_GraphicView::paintEvent()
+ */
+class LC_TileCache {
+public:
+	//! edge length of a tile in pixels
+	static const int TileSize = 256;
+
+	/**
+	 * binds the cache to a zoom factor, drops all tiles if it changed
+	 * @return true if the tiles were dropped
+	 */
+	bool setFactor(const RS_Vector& factor);
+	/** drops all tiles */
+	void clear();
+	/** marks the tiles intersecting area, in world pixels, as stale */
+	void invalidate(const QRect& area);
+	/** marks all tiles as stale */
+	void invalidateAll();
+	/** marks the draft tiles as stale */
+	void invalidateDrafts();
+
+	/**
+	 * @param stale set to true if the tile has to be rendered again
+	 * @return the cached tile in column tx and row ty, or nullptr
+	 */
+	QPixmap* find(int tx, int ty, bool* stale = nullptr);
+	/** stores the rendered tile in column tx and row ty */
+	void insert(int tx, int ty, const QPixmap& pixmap, bool draft = false);
+
+	/** starts a new frame, tiles not used since are pruned first */
+	void nextFrame();
+	/** drops the least recently used tiles until at most maxTiles are left */
+	void prune(size_t maxTiles);
+
+	size_t size() const;
+	/** incremented whenever tiles are stored, dropped or marked stale */
+	unsigned generation() const;
+
+	/** @return row or column of the tile containing a world pixel */
+	static int tileIndex(int pixel);
+
+private:
+	struct Tile {
+		QPixmap pixmap;
+		int tx;
+		int ty;
+		unsigned lastUsed;
+		bool stale;
+		bool draft;
+	};
+	static long long key(int tx, int ty);
+
+	std::unordered_map<long long, Tile> tiles;
+	RS_Vector factor{false};
+	unsigned frame = 0;
+	unsigned gen = 0;
+};
+
+#endif // LC_TILECACHE_H
@@ -0,0 +1,391 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QTimer>
+
+#include "lc_tilerenderer.h"
+#include "lc_spatialindex.h"
+#include "lc_tilecache.h"
+#include "rs_graphic.h"
+#include "rs_painterqt.h"
+#include "rs_staticgraphicview.h"
+
+namespace {
+//! milliseconds to render a draft tile
+const qint64 draftBudget = 16;
+
+/**
+ * @return the graphic, or the container if it isn't part of one, that
+ * the view shows. Views of its blocks belong to the graphic as well, the
+ * blocks are drawn by the inserts of the graphic.
+ */
+RS_EntityContainer* documentOf(RS_GraphicView* view)
+{
+	RS_EntityContainer* container = view->getContainer();
+	if (!container)
+		return nullptr;
+	RS_Graphic* graphic = container->getGraphic();
+	return graphic ? graphic : container;
+}
+
+/** @return the graphic view which object is part of, if any */
+RS_GraphicView* graphicViewOf(QObject* object)
+{
+	for (; object; object = object->parent()) {
+		RS_GraphicView* view = qobject_cast<RS_GraphicView*>(object);
+		if (view)
+			return view;
+	}
+	return nullptr;
+}
+}
+
+/**
+ * View of one worker, drawing into a tile. Stops drawing as soon as
+ * the renderer is cancelled, or suspended while drawing a full tile.
+ */
+class LC_TileRenderer::TileView: public RS_StaticGraphicView {
+public:
+	TileView(const QAtomicInt& cancelling, const QAtomicInt& yielding):
+		RS_StaticGraphicView(LC_TileCache::TileSize, LC_TileCache::TileSize, nullptr)
+	  , cancelling(cancelling)
+	  , yielding(yielding)
+	{
+	}
+
+	using RS_GraphicView::drawEntity;
+	virtual void drawEntity(RS_Painter* painter, RS_Entity* e, double& patternOffset) {
+		if (cancelling.load() || interrupted)
+			return;
+		// drafts stop between entities, see drawDraft()
+		if (!draft && yielding.load()) {
+			interrupted = true;
+			return;
+		}
+		RS_GraphicView::drawEntity(painter, e, patternOffset);
+	}
+
+	/**
+	 * Draws the entities in the tile, largest first, until the draft
+	 * budget is used up or the workers are paused. Entities smaller than
+	 * a pixel are drawn as points, hatches and texts as their bounding
+	 * boxes.
+	 */
+	void drawDraft(RS_Painter* painter) {
+		QElapsedTimer timer;
+		timer.start();
+		if (!isPrintPreview())
+			drawAbsoluteZero(painter);
+		if (!container)
+			return;
+
+		std::vector<std::pair<double, RS_Entity*>> order;
+		for (RS_Entity* e: container->entitiesInRect(getViewRect(getCullingMargin()))) {
+			double size = RS_MAXDOUBLE;
+			if (LC_SpatialIndex::isBounded(e)) {
+				RS_Vector const d = e->getMax() - e->getMin();
+				size = std::max(d.x, d.y);
+			}
+			order.emplace_back(size, e);
+		}
+		std::stable_sort(order.begin(), order.end(),
+						 [](std::pair<double, RS_Entity*> const& a,
+						 std::pair<double, RS_Entity*> const& b) {
+			return a.first > b.first;
+		});
+
+		double const pixel = 1./getFactor().x;
+		for (auto const& o: order) {
+			if (timer.elapsed() > draftBudget || cancelling.load()
+					|| yielding.load())
+				break;
+			RS_Entity* e = o.second;
+			painter->setDrawSelectedOnly(e->isSelected());
+			bool const box = e->rtti()==RS2::EntityHatch
+					|| e->rtti()==RS2::EntityText
+					|| e->rtti()==RS2::EntityMText;
+			if (o.first >= pixel && !box) {
+				drawEntity(painter, e);
+				continue;
+			}
+			if (!e->isVisible())
+				continue;
+			setPenForEntity(painter, e);
+			if (o.first < pixel)
+				painter->drawPoint(toGui((e->getMin() + e->getMax())*0.5));
+			else
+				painter->drawRect(toGui(e->getMin()), toGui(e->getMax()));
+		}
+	}
+
+	bool draft = false;
+	//! set if drawing the tile stopped for suspend()
+	bool interrupted = false;
+
+private:
+	const QAtomicInt& cancelling;
+	const QAtomicInt& yielding;
+};
+
+class LC_TileRenderer::Job: public QRunnable {
+public:
+	Job(LC_TileRenderer* renderer, int tx, int ty, uint batch, bool draft):
+		renderer(renderer)
+	  , tx(tx)
+	  , ty(ty)
+	  , batch(batch)
+	  , draft(draft)
+	{
+	}
+
+	virtual void run() {
+		renderer->render(tx, ty, batch, draft);
+	}
+
+private:
+	LC_TileRenderer* renderer;
+	int tx;
+	int ty;
+	uint batch;
+	bool draft;
+};
+
+LC_TileRenderer::LC_TileRenderer(RS_GraphicView* view):
+	view(view)
+{
+	int const threads = std::max(1, QThread::idealThreadCount());
+	pool.setMaxThreadCount(threads);
+	for (int i = 0; i < threads; ++i) {
+		views.emplace_back(new TileView(cancelling, yielding));
+		freeViews.push_back(views.back().get());
+	}
+	connect(this, SIGNAL(rendered(int,int,uint,QImage,bool)),
+			this, SLOT(slotRendered(int,int,uint,QImage,bool)),
+			Qt::QueuedConnection);
+	connect(this, SIGNAL(interrupted(int,int,uint)),
+			this, SLOT(slotInterrupted(int,int,uint)),
+			Qt::QueuedConnection);
+}
+
+LC_TileRenderer::~LC_TileRenderer()
+{
+	cancel();
+}
+
+void LC_TileRenderer::setAntialiasing(bool on)
+{
+	cancel();
+	antialiasing = on;
+}
+
+void LC_TileRenderer::request(int tx, int ty, bool draft)
+{
+	if (!pending.insert(key(tx, ty)).second)
+		return;
+
+	if (pending.size() == 1) {
+		// a new batch: the workers are idle and take over the current
+		// settings, the entities are made safe to draw concurrently
+		for (auto& v: views)
+			v->copyDrawingSettings(*view);
+		// drafts make do with entities prepared for another zoom factor
+		double const factor = view->getFactor().x;
+		RS_EntityContainer* container = view->getContainer();
+		if (container && !(prepared && (draft || factor == preparedFactor))) {
+			RS_Graphic* graphic = container->getGraphic();
+			if (graphic)
+				graphic->prepareDrawing(view);
+			else
+				container->prepareDrawing(view);
+			preparedFactor = factor;
+		}
+		prepared = true;
+		qApp->installEventFilter(this);
+	}
+	pool.start(new Job(this, tx, ty, batch, draft));
+}
+
+bool LC_TileRenderer::isPending(int tx, int ty) const
+{
+	return pending.count(key(tx, ty)) > 0;
+}
+
+void LC_TileRenderer::cancel()
+{
+	if (pending.empty())
+		return;
+	cancelling.store(1);
+	resume();
+	pool.clear();
+	pool.waitForDone();
+	cancelling.store(0);
+
+	pending.clear();
+	++batch;
+	qApp->removeEventFilter(this);
+	emit cancelled();
+}
+
+void LC_TileRenderer::suspend()
+{
+	if (suspended || pending.empty())
+		return;
+	yielding.store(1);
+	documentLock.lockForWrite();
+	yielding.store(0);
+	suspended = true;
+	QTimer::singleShot(0, this, SLOT(resume()));
+}
+
+void LC_TileRenderer::resume()
+{
+	if (!suspended)
+		return;
+	suspended = false;
+	documentLock.unlock();
+}
+
+void LC_TileRenderer::invalidate()
+{
+	cancel();
+	prepared = false;
+}
+
+/**
+ * Cancels rendering before input that may modify the document is
+ * handled, and pauses it for mouse moves over any view of the document.
+ * Painting, timers and other events only read the document.
+ */
+bool LC_TileRenderer::eventFilter(QObject* object, QEvent* event)
+{
+	switch (event->type()) {
+	case QEvent::MouseMove: {
+		// snapping and highlighting update entities, e.g. the lines of
+		// splines are created, but nothing prepareDrawing() computed.
+		// Any view of the document may do so, e.g. a second window or
+		// the window of a block.
+		RS_GraphicView* target = graphicViewOf(object);
+		if (target && (target == view || documentOf(target) == documentOf(view)))
+			suspend();
+		break;
+	}
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	case QEvent::MouseButtonDblClick:
+	case QEvent::KeyPress:
+	case QEvent::KeyRelease:
+	case QEvent::Wheel:
+	case QEvent::Shortcut:
+	case QEvent::Drop:
+	case QEvent::TabletPress:
+	case QEvent::TabletRelease:
+	case QEvent::ContextMenu:
+	case QEvent::Close:
+		cancel();
+		break;
+	default:
+		break;
+	}
+	return QObject::eventFilter(object, event);
+}
+
+void LC_TileRenderer::slotRendered(int tx, int ty, uint tileBatch,
+								   const QImage& image, bool draft)
+{
+	if (tileBatch != batch || !pending.erase(key(tx, ty)))
+		return;
+	if (pending.empty())
+		qApp->removeEventFilter(this);
+	emit tileRendered(tx, ty, image, draft);
+}
+
+void LC_TileRenderer::slotInterrupted(int tx, int ty, uint tileBatch)
+{
+	if (tileBatch == batch && pending.count(key(tx, ty)))
+		pool.start(new Job(this, tx, ty, batch, false));
+}
+
+/**
+ * Renders one tile in a worker thread, see QG_GraphicView::paintEvent()
+ * for the passes.
+ */
+void LC_TileRenderer::render(int tx, int ty, uint tileBatch, bool draft)
+{
+	QReadLocker documentLocker(&documentLock);
+	if (cancelling.load())
+		return;
+
+	TileView* tileView;
+	{
+		QMutexLocker lock(&freeViewsMutex);
+		tileView = freeViews.back();
+		freeViews.pop_back();
+	}
+
+	int const size = LC_TileCache::TileSize;
+	// world pixel (tx, ty)*TileSize is mapped to (0, 0) of the tile
+	tileView->setOffset(-tx*size, (ty + 1)*size);
+	tileView->draft = draft;
+	tileView->interrupted = false;
+
+	QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	RS_PainterQt painter(&image);
+	if (antialiasing)
+		painter.setRenderHint(QPainter::Antialiasing);
+	painter.setDrawingMode(tileView->getDrawingMode());
+	if (draft) {
+		tileView->drawDraft(&painter);
+	} else {
+		painter.setDrawSelectedOnly(false);
+		tileView->drawLayer2(&painter);
+		painter.setDrawSelectedOnly(true);
+		tileView->drawLayer2(&painter);
+	}
+	painter.end();
+
+	bool const wasInterrupted = tileView->interrupted;
+	{
+		QMutexLocker lock(&freeViewsMutex);
+		freeViews.push_back(tileView);
+	}
+
+	// a partly drawn tile is dropped
+	if (cancelling.load())
+		return;
+	if (wasInterrupted)
+		emit interrupted(tx, ty, tileBatch);
+	else
+		emit rendered(tx, ty, tileBatch, image, draft);
+}
+
+long long LC_TileRenderer::key(int tx, int ty)
+{
+	return (static_cast<long long>(tx) << 32)
+			| static_cast<unsigned>(ty);
+}
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2015 librecad.org (www.librecad.org)
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_TILERENDERER_H
+#define LC_TILERENDERER_H
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+#include <QAtomicInt>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QThreadPool>
+
+class RS_GraphicView;
+
+/**
+ * Renders tiles of the drawing of a graphic view in worker threads.
+ *
+ * Each worker draws one tile at a time into its own image, with its own
+ * copy of the view settings. The entities are only read while drawing:
+ * RS_Entity::prepareDrawing() is called on the GUI thread before the
+ * first tile of a batch is queued, and user input that may modify the
+ * document cancels the batch and waits for the workers before it is
+ * delivered. Mouse moves over any view of the document, e.g. a second
+ * window or the window of a block, only pause the workers, tiles that
+ * are not drafts are interrupted and queued again. The entities are
+ * prepared again after invalidate() only.
+ *
+ * Draft tiles are rendered within a time budget: the largest entities
+ * are drawn first, tiny entities as points and hatches and texts as
+ * boxes. Drafts hold the document like other tiles, a pause waits for
+ * the entity being drawn and the rest of the draft is skipped.
+ *
+ * @see LC_TileCache
+ */
+class LC_TileRenderer: public QObject {
+	Q_OBJECT
+public:
+	explicit LC_TileRenderer(RS_GraphicView* view);
+	~LC_TileRenderer();
+
+	void setAntialiasing(bool on);
+	/**
+	 * Queues rendering of the tile in column tx and row ty, in world
+	 * pixels of the current zoom factor of the view.
+	 */
+	void request(int tx, int ty, bool draft = false);
+	/** @return true if the tile is queued or being rendered */
+	bool isPending(int tx, int ty) const;
+	/**
+	 * Drops the queued tiles and waits for the tiles being rendered,
+	 * none of them is reported.
+	 */
+	void cancel();
+	/**
+	 * Cancels rendering, the entities are prepared again before the
+	 * next tile. Needed after the document or the zoom factor changed.
+	 */
+	void invalidate();
+
+signals:
+	void tileRendered(int tx, int ty, const QImage& image, bool draft);
+	/** queued tiles were dropped by cancel() */
+	void cancelled();
+	//! emitted by the workers, tiles of old batches are discarded
+	void rendered(int tx, int ty, uint batch, const QImage& image, bool draft);
+	//! emitted by the workers for tiles interrupted by suspend()
+	void interrupted(int tx, int ty, uint batch);
+
+protected:
+	bool eventFilter(QObject* object, QEvent* event) override;
+
+private slots:
+	void slotRendered(int tx, int ty, uint batch, const QImage& image, bool draft);
+	void slotInterrupted(int tx, int ty, uint batch);
+	void resume();
+
+private:
+	class TileView;
+	class Job;
+
+	void render(int tx, int ty, uint batch, bool draft);
+	/**
+	 * Waits for the tiles being rendered and pauses the workers until
+	 * the current event is handled.
+	 */
+	void suspend();
+	static long long key(int tx, int ty);
+
+	RS_GraphicView* view;
+	QThreadPool pool;
+	//! one view per worker, created on the GUI thread
+	std::vector<std::unique_ptr<TileView>> views;
+	std::vector<TileView*> freeViews;
+	QMutex freeViewsMutex;
+	//! set while cancel() waits for the workers
+	QAtomicInt cancelling;
+	//! set while suspend() waits for the workers
+	QAtomicInt yielding;
+	//! read by the workers while they draw, written by suspend()
+	QReadWriteLock documentLock;
+	bool suspended = false;
+	//! tiles queued or being rendered, used on the GUI thread only
+	std::unordered_set<long long> pending;
+	uint batch = 0;
+	//! the entities are prepared for drawing, see RS_Entity::prepareDrawing()
+	bool prepared = false;
+	//! zoom factor the entities were prepared for
+	double preparedFactor = 0.;
+	bool antialiasing = false;
+};
+
+#endif // LC_TILERENDERER_H
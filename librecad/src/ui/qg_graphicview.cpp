@@ -26,6 +26,9 @@
 
 #include "qg_graphicview.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <QGridLayout>
 #include <QLabel>
 #include <QMenu>
@@ -42,6 +45,8 @@
 #include "rs_actionselectsingle.h"
 #include "rs_settings.h"
 #include "rs_painterqt.h"
+#include "rs_overlaybox.h"
+#include "rs_overlayline.h"
 #include "rs_dialogfactory.h"
 #include "qg_dialogfactory.h"
 #include "rs_eventhandler.h"
@@ -115,6 +120,17 @@ QG_GraphicView::QG_GraphicView(QWidget* parent, Qt::WindowFlags f, RS_Document*
     connect(vScrollBar, SIGNAL(valueChanged(int)),
             this, SLOT(slotVScrolled(int)));
 
+    connect(&tileRenderer, SIGNAL(tileRendered(int,int,QImage,bool)),
+            this, SLOT(slotTileRendered(int,int,QImage,bool)));
+    connect(&tileRenderer, SIGNAL(cancelled()),
+            this, SLOT(slotTilesCancelled()));
+
+    // the drawing is refined once panning or zooming paused that long
+    interactionTimer.setSingleShot(true);
+    interactionTimer.setInterval(200);
+    connect(&interactionTimer, SIGNAL(timeout()),
+            this, SLOT(slotViewIdle()));
+
     // Dummy widgets for scrollbar corners:
     //layout->addWidget(new QWidget(this), 1, 1);
     //QWidget* w = new QWidget(this);
@@ -143,6 +159,7 @@ QG_GraphicView::QG_GraphicView(QWidget* parent, Qt::WindowFlags f, RS_Document*
  * Destructor
  */
 QG_GraphicView::~QG_GraphicView() {
+	tileRenderer.cancel();
 	cleanUp();
 }
 
@@ -275,12 +292,32 @@ void QG_GraphicView::updateGridStatusWidget(const QString& text) {
  */
 void QG_GraphicView::redraw(RS2::RedrawMethod method) {
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | method);
-        update(); // Paint when reeady to pain
+        // the overlay alone: only where it was and where it is now
+        if (redrawMethod == RS2::RedrawOverlay && PixmapLayer3)
+            update(overlayDrawn + overlayRegion());
+        else
+            update(); // Paint when reeady to pain
 //	repaint(); //Paint immediate
 }
 
 
 
+/**
+ * Redraws the tiles of the drawing intersecting area when the next
+ * paint event is handled.
+ */
+void QG_GraphicView::redrawArea(const LC_Rect& area) {
+    // many small changes: cheaper to start over
+    if (damagedAreas.size() >= 256) {
+        redraw(RS2::RedrawDrawing);
+        return;
+    }
+    damagedAreas.push_back(area);
+    update();
+}
+
+
+
 void QG_GraphicView::resizeEvent(QResizeEvent* /*e*/) {
     RS_DEBUG->print("QG_GraphicView::resizeEvent begin");
     adjustOffsetControls();
@@ -288,7 +325,7 @@ void QG_GraphicView::resizeEvent(QResizeEvent* /*e*/) {
 //     updateGrid();
         // Small hack, delete teh snapper during resizes
         getOverlayContainer(RS2::Snapper)->clear();
-        redraw();
+        redraw(RS2::RedrawView);
     RS_DEBUG->print("QG_GraphicView::resizeEvent end");
 }
 
@@ -549,7 +586,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
 //                setCurrentAction(new RS_ActionZoomScroll(numPixels.x(), numPixels.y(),
 //                                                         *container, *this));
             }
-            redraw();
+            redraw(RS2::RedrawView);
         }
         e->accept();
         return;
@@ -619,7 +656,7 @@ void QG_GraphicView::wheelEvent(QWheelEvent *e) {
         }
     }
 
-        redraw();
+        redraw(RS2::RedrawView);
 
     e->accept();
 }
@@ -786,7 +823,7 @@ void QG_GraphicView::slotHScrolled(int value) {
     }
     //if (isUpdateEnabled()) {
 //         updateGrid();
-    redraw();
+    redraw(RS2::RedrawView);
 }
 
 
@@ -809,7 +846,7 @@ void QG_GraphicView::slotVScrolled(int value) {
     }
     //if (isUpdateEnabled()) {
   //  updateGrid();
-    redraw();
+    redraw(RS2::RedrawView);
 }
 /**
  * @brief setOffset
@@ -871,14 +908,19 @@ void QG_GraphicView::layerActivated(RS_Layer *layer) {
  * usually that's very fast since we only paint the buffer we
  * have from the last call..
  */
-void QG_GraphicView::paintEvent(QPaintEvent *)
+void QG_GraphicView::paintEvent(QPaintEvent *e)
 {
     RS_DEBUG->print("QG_GraphicView::paintEvent begin");
 
     // Re-Create or get the layering pixmaps
+    bool const resized = !PixmapLayer3
+            || PixmapLayer3->size() != QSize(getWidth(), getHeight());
     getPixmapForView(PixmapLayer1);
     getPixmapForView(PixmapLayer2);
     getPixmapForView(PixmapLayer3);
+    getPixmapForView(PixmapLayers12);
+    if (resized)
+        redrawMethod = RS2::RedrawAll;
 
     // Draw Layer 1
     if (redrawMethod & RS2::RedrawGrid)
@@ -889,43 +931,271 @@ void QG_GraphicView::paintEvent(QPaintEvent *)
         painter1.end();
     }
 
+    // Draw layer 2 from the tiles, the ones not cached are rendered in
+    // the background. Tiles being rendered may be outdated now.
+    if (drawingTiles.setFactor(getFactor()))
+    {
+        tileRenderer.cancel();
+        interactionTimer.start();
+    }
     if (redrawMethod & RS2::RedrawDrawing)
     {
-        // DRaw layer 2
-        PixmapLayer2->fill(Qt::transparent);
-        RS_PainterQt painter2(PixmapLayer2.get());
-        if (antialiasing)
+        tileRenderer.invalidate();
+        drawingTiles.invalidateAll();
+    }
+    else if (!damagedAreas.empty())
+    {
+        tileRenderer.invalidate();
+        for (LC_Rect const& area: damagedAreas)
         {
-            painter2.setRenderHint(QPainter::Antialiasing);
+            QRect const pixels = toTilePixels(area);
+            if (pixels.isNull())
+                drawingTiles.invalidateAll();
+            else
+                drawingTiles.invalidate(pixels);
         }
-        painter2.setDrawingMode(drawingMode);
-        painter2.setDrawSelectedOnly(false);
-        drawLayer2((RS_Painter*)&painter2);
-        painter2.setDrawSelectedOnly(true);
-        drawLayer2((RS_Painter*)&painter2);
-        painter2.end();
+    }
+    damagedAreas.clear();
+    bool const drawingChanged = updateDrawingLayer();
+
+    // Layers 1 and 2 are composed once, not in every paint event
+    bool const baseChanged = (redrawMethod & RS2::RedrawGrid) || drawingChanged;
+    if (baseChanged)
+    {
+        QPainter painter(PixmapLayers12.get());
+        painter.drawPixmap(0, 0, *PixmapLayer1);
+        painter.drawPixmap(0, 0, *PixmapLayer2);
+        painter.end();
     }
 
+    // Layer 3 is cleared and drawn again where the overlay was and is,
+    // crosshair, snap marker and preview usually cover a small part
+    QRegion damage;
     if (redrawMethod & RS2::RedrawOverlay)
     {
-        PixmapLayer3->fill(Qt::transparent);
+        QRegion const overlay = overlayRegion();
+        damage = resized ? QRegion(rect()) : overlayDrawn + overlay;
+        QPainter clear(PixmapLayer3.get());
+        clear.setCompositionMode(QPainter::CompositionMode_Source);
+        for (QRect const& r: damage.rects())
+            clear.fillRect(r, Qt::transparent);
+        clear.end();
+
         RS_PainterQt painter3(PixmapLayer3.get());
+        painter3.setClipRegion(damage);
         drawLayer3((RS_Painter*)&painter3);
         painter3.end();
+        overlayDrawn = overlay;
     }
 
+    // parts changed outside of the requested area are painted next
+    QRegion const changed = baseChanged ? QRegion(rect()) : damage;
+    QRegion const missed = changed - e->region();
+    if (!missed.isEmpty())
+        update(missed);
+
     // Finally paint the layers back on the screen, bitblk to the rescue!
     RS_PainterQt wPainter(this);
-    wPainter.drawPixmap(0,0,*PixmapLayer1);
-    wPainter.drawPixmap(0,0,*PixmapLayer2);
-    wPainter.drawPixmap(0,0,*PixmapLayer3);
+    for (QRect const& r: e->region().rects())
+    {
+        wPainter.drawPixmap(r, *PixmapLayers12, r);
+        wPainter.drawPixmap(r, *PixmapLayer3, r);
+    }
     wPainter.end();
 
     redrawMethod=RS2::RedrawNone;
     RS_DEBUG->print("QG_GraphicView::paintEvent end");
 }
 
+/**
+ * The relative zero marker and the bounding boxes of the overlay
+ * entities, with a margin for pens and handles. Large previews are
+ * covered by a single rectangle.
+ */
+QRegion QG_GraphicView::overlayRegion()
+{
+    int const margin = getCullingMargin();
+    std::vector<QRect> rects;
+    RS_Vector const& zero = getRelativeZero();
+    if (zero.valid)
+    {
+        RS_Vector const vp = toGui(zero);
+        // see drawRelativeZero()
+        int const zr = 5 + 2;
+        rects.emplace_back(int(vp.x) - zr, int(vp.y) - zr, 2*zr + 1, 2*zr + 1);
+    }
+    addOverlayRects(rects, getOverlayContainer(RS2::ActionPreviewEntity), margin);
+    addOverlayRects(rects, getOverlayContainer(RS2::Snapper), margin);
+
+    QRegion region;
+    if (rects.size() > 32)
+    {
+        QRect bounds;
+        for (QRect const& r: rects)
+            bounds |= r;
+        region = bounds;
+    }
+    else
+    {
+        for (QRect const& r: rects)
+            region += r;
+    }
+    return region & rect();
+}
+
+void QG_GraphicView::addOverlayRects(std::vector<QRect>& rects, RS_Entity* e, int margin) const
+{
+    if (!e)
+        return;
+    if (e->rtti() == RS2::EntityContainer || e->rtti() == RS2::EntityPreview)
+    {
+        for (RS_Entity* child: *static_cast<RS_EntityContainer*>(e))
+            addOverlayRects(rects, child, margin);
+        return;
+    }
+
+    RS_Vector v1;
+    RS_Vector v2;
+    if (e->rtti() == RS2::EntityOverlayBox)
+    {
+        RS_OverlayBox const* box = static_cast<RS_OverlayBox*>(e);
+        v1 = toGui(box->getCorner1());
+        v2 = toGui(box->getCorner2());
+    }
+    else if (dynamic_cast<RS_OverlayLine*>(e))
+    {
+        // in screen coordinates already
+        v1 = e->getMin();
+        v2 = e->getMax();
+    }
+    else
+    {
+        v1 = toGui(e->getMin());
+        v2 = toGui(e->getMax());
+    }
+
+    // clamped to the view, infinite or unknown extents cover all of it
+    double const w = getWidth();
+    double const h = getHeight();
+    auto clamp = [margin](double v, double limit) {
+        return std::isfinite(v) ? std::min(std::max(v, -1.0*margin), limit + margin) : NAN;
+    };
+    double const left = clamp(std::min(v1.x, v2.x), w);
+    double const right = clamp(std::max(v1.x, v2.x), w);
+    double const top = clamp(std::min(v1.y, v2.y), h);
+    double const bottom = clamp(std::max(v1.y, v2.y), h);
+    if (!v1.valid || !v2.valid || std::isnan(left + right + top + bottom))
+    {
+        rects.push_back(rect());
+        return;
+    }
+    rects.emplace_back(QPoint(int(std::floor(left)) - margin, int(std::floor(top)) - margin),
+                       QPoint(int(std::ceil(right)) + margin, int(std::ceil(bottom)) + margin));
+}
+
+/**
+ * Composes PixmapLayer2 from the tiles covering the view, if the view
+ * or the tiles changed since it was last composed. Missing and stale
+ * tiles are requested from the renderer, stale ones are shown until
+ * they are replaced. While the view is moved, draft tiles are requested,
+ * so that new areas show up quickly regardless of the drawing size.
+ */
+bool QG_GraphicView::updateDrawingLayer()
+{
+    int const w = getWidth();
+    int const h = getHeight();
+    // the view in world pixels, see toGui()
+    QRect const area(-getOffsetX(), getOffsetY() - h, w, h);
+    if (area != viewArea)
+    {
+        if (!viewArea.isNull())
+            interactionTimer.start();
+        viewArea = area;
+    }
+    if (area == composedArea && composedGeneration == drawingTiles.generation())
+        return false;
+
+    drawingTiles.nextFrame();
+    int const tx0 = LC_TileCache::tileIndex(area.left());
+    int const tx1 = LC_TileCache::tileIndex(area.right());
+    int const ty0 = LC_TileCache::tileIndex(area.top());
+    int const ty1 = LC_TileCache::tileIndex(area.bottom());
+
+    PixmapLayer2->fill(Qt::transparent);
+    QPainter painter(PixmapLayer2.get());
+    for (int ty = ty0; ty <= ty1; ++ty)
+    {
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            bool stale = false;
+            QPixmap const* tile = drawingTiles.find(tx, ty, &stale);
+            if (!tile || stale)
+            {
+                tileRenderer.request(tx, ty, interactionTimer.isActive());
+            }
+            if (tile)
+            {
+                painter.drawPixmap(tx*LC_TileCache::TileSize - area.left(),
+                                   ty*LC_TileCache::TileSize - area.top(), *tile);
+            }
+        }
+    }
+    painter.end();
+
+    // keep the tiles of a few screens around for panning
+    size_t const visible = (tx1 - tx0 + 1)*(ty1 - ty0 + 1);
+    drawingTiles.prune(std::max<size_t>(64, 4*visible));
+    composedArea = area;
+    composedGeneration = drawingTiles.generation();
+    return true;
+}
+
+void QG_GraphicView::slotTileRendered(int tx, int ty, const QImage& image, bool draft)
+{
+    drawingTiles.insert(tx, ty, QPixmap::fromImage(image), draft);
+    update();
+}
+
+/**
+ * Tiles dropped by the renderer are requested again by the next paint
+ * event.
+ */
+void QG_GraphicView::slotTilesCancelled()
+{
+    composedArea = QRect();
+    update();
+}
+
+/**
+ * Replaces the draft tiles rendered while the view was moved.
+ */
+void QG_GraphicView::slotViewIdle()
+{
+    tileRenderer.cancel();
+    drawingTiles.invalidateDrafts();
+    update();
+}
+
+QRect QG_GraphicView::toTilePixels(const LC_Rect& area) const
+{
+    RS_Vector const& f = getFactor();
+    double const margin = getCullingMargin();
+    double const left = std::floor(area.minP().x*f.x - margin);
+    double const right = std::ceil(area.maxP().x*f.x + margin);
+    double const top = std::floor(-area.maxP().y*f.y - margin);
+    double const bottom = std::ceil(-area.minP().y*f.y + margin);
+    double const limit = 1e9;
+    if (!(left > -limit && right < limit && top > -limit && bottom < limit))
+        return QRect();
+    return QRect(QPoint(int(left), int(top)), QPoint(int(right), int(bottom)));
+}
+
 void QG_GraphicView::set_antialiasing(bool state)
 {
-	antialiasing = state;
+	tileRenderer.setAntialiasing(state);
+}
+
+void QG_GraphicView::cancelRendering()
+{
+	tileRenderer.invalidate();
 }
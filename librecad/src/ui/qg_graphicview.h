@@ -27,9 +27,14 @@
 #ifndef QG_GRAPHICVIEW_H
 #define QG_GRAPHICVIEW_H
 
+#include <vector>
+#include <QRegion>
+#include <QTimer>
 #include <QWidget>
 
 #include "rs_graphicview.h"
+#include "lc_tilecache.h"
+#include "lc_tilerenderer.h"
 #include "rs_layerlistlistener.h"
 #include "rs_blocklistlistener.h"
 
@@ -57,6 +62,7 @@ public:
 	virtual int getWidth() const;
 	virtual int getHeight() const;
 	virtual void redraw(RS2::RedrawMethod method=RS2::RedrawAll);
+	virtual void redrawArea(const LC_Rect& area);
     virtual void adjustOffsetControls();
     virtual void adjustZoomControls();
     virtual void setBackground(const RS_Color& bg);
@@ -90,6 +96,11 @@ public:
     virtual RS_Vector getMousePosition() const;
 
 	void set_antialiasing(bool state);
+	/**
+	 * Stops the tiles being rendered in the background. Needed before
+	 * the document is modified other than in response to user input.
+	 */
+	void cancelRendering();
 
 protected:
     virtual void emulateMouseMoveEvent();
@@ -114,6 +125,9 @@ protected:
 private slots:
     void slotHScrolled(int value);
     void slotVScrolled(int value);
+    void slotTileRendered(int tx, int ty, const QImage& image, bool draft);
+    void slotTilesCancelled();
+    void slotViewIdle();
 
 protected:
     //! Horizontal scrollbar.
@@ -139,6 +153,7 @@ protected:
 	std::unique_ptr<QPixmap> PixmapLayer1;  // Used for grids and absolute 0
 	std::unique_ptr<QPixmap> PixmapLayer2;  // Used for teh actual CAD drawing
 	std::unique_ptr<QPixmap> PixmapLayer3;  // USed for crosshair and actionitems
+	std::unique_ptr<QPixmap> PixmapLayers12;  // Layers 1 and 2 composed
 	
 	RS2::RedrawMethod redrawMethod;
 		
@@ -146,7 +161,31 @@ protected:
     bool isSmoothScrolling;
 
 private:
-	bool antialiasing{false};
+	/** @return true if PixmapLayer2 was composed again */
+	bool updateDrawingLayer();
+	/**
+	 * @return the part of the view covered by the overlay, the area
+	 * of PixmapLayer3 to clear when it is drawn again
+	 */
+	QRegion overlayRegion();
+	void addOverlayRects(std::vector<QRect>& rects, RS_Entity* e, int margin) const;
+	/** @return area in world pixels of the tile cache, null on overflow */
+	QRect toTilePixels(const LC_Rect& area) const;
+
+	//! rendered drawing, composed into PixmapLayer2
+	LC_TileCache drawingTiles;
+	LC_TileRenderer tileRenderer{this};
+	//! areas of the drawing changed since the last paint event
+	std::vector<LC_Rect> damagedAreas;
+	//! view area and tile generation of PixmapLayer2
+	QRect composedArea;
+	unsigned composedGeneration{0};
+	//! view area of the last paint event, in world pixels
+	QRect viewArea;
+	//! runs while the view is moved, draft tiles are rendered meanwhile
+	QTimer interactionTimer;
+	//! area of PixmapLayer3 drawn by the last paint event
+	QRegion overlayDrawn;
 
 signals:
     void xbutton1_was_pressed();
@@ -441,6 +441,7 @@ QString QG_LibraryWidget::getPathToPixmap(const QString& dir,
             }
             gv.drawEntity(&painter, e);
         }
+        painter.flush();
 
         QImageWriter iio;
         QImage img;